@@ -0,0 +1,562 @@
+#include "bridge.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/stdlib.h"
+#include "cec/cec_txq.h"
+#include "cec/cec_topo.h"
+#include "cec/cec_dedup.h"
+#include "cec/cec_la.h"
+#include "ri/ri_tx.h"
+#include "led/led.h"
+#include "diag/stall.h"
+#include "config.h"
+#include "log.h"
+
+// HDMI0 = 0.0.0.0
+#define CEC_PHYS_ADDR_HI 0x00
+#define CEC_PHYS_ADDR_LO 0x00
+
+#define CEC_LA  BRIDGE_LA
+#define CEC_BR  CEC_ADDR_BROADCAST
+
+#define RI_DEBOUNCE_US        2000000
+#define RI_INPUT_SEL_DELAY_MS 200
+#define RI_VOL_BURST_INTERVAL_MS 80  // 絶対音量ランプの RI ステップ間隔 (1 フレーム ≒ 60 ms)
+#define AUDIO_REPORT_INTERVAL_MS 250  // 自発的な Report Audio Status の最短間隔 (間の変化はまとめる)
+#define RI_SEEN_TIMEOUT_MS    300000  // RI 受信がこれだけ途絶えたら、確認済みの電源状態を信用しない
+
+// ---- デバイス状態 ----
+
+typedef struct {
+    bool            power_on;
+    bool            power_seen;  // power_on を RI 受信で確認済み (RI_SEEN_TIMEOUT_MS で失効)
+    absolute_time_t ri_seen_at;  // 最後に RI を受信した時刻
+    bool            system_audio_mode;
+    uint8_t         volume;      // 0-100 (仮想値, RI 受信した Vol Up / Down だけ追従)
+    bool            mute;
+    absolute_time_t last_on;     // Power ON デバウンス用
+    absolute_time_t last_off;    // Power OFF デバウンス用
+
+    // 絶対音量 (Set Audio Volume Level) → RI ステップのランプ
+    bool            vol_ramp;       // 目標へ向けて送出中
+    uint8_t         vol_target;
+    absolute_time_t vol_next;       // 次のステップ送出可能時刻
+    absolute_time_t vol_ramp_start; // 目標設定時刻 (レイテンシ計測用)
+    uint32_t        vol_lat_max_ms; // 目標到達までの最大時間
+
+    // 音量 / ミュート変化の TV への通知 (Report Audio Status)
+    bool            audio_dirty;    // 未通知の変化あり
+    uint8_t         audio_reported; // 最後に送った Audio Status バイト (0xFF = 未送信)
+    absolute_time_t audio_next;     // 次に自発送信できる時刻
+} device_state_t;
+
+static device_state_t g_state = {
+    .power_on          = false,
+    .system_audio_mode = false,
+    .volume            = 30,
+    .mute              = false,
+    .audio_reported    = 0xFF,
+};
+
+// ---- ユーティリティ ----
+
+static inline uint8_t hdr(uint8_t src, uint8_t dst) {
+    return (uint8_t)((src << 4) | (dst & 0x0F));
+}
+
+// ---- CEC 送信ヘルパー ----
+
+// CEC TX キュー投入 (LED フラッシュ付き)
+// directed は応答として最優先、broadcast はその後に送る。結果はキューがログ出力する。
+static bool cec_tx_queue_led(const uint8_t *bytes, size_t len, const char *tag) {
+    // 論理アドレスを確保するまで (確保前 / 他の機器が使用中) は、そのアドレスを名乗って送らない
+    if (!cec_la_claimed()) {
+        LOG_D("  %s: LA not ours, not sent\n", tag);
+        return false;
+    }
+    led_flash(LED_CH_CEC_TX);
+    bool broadcast = (bytes[0] & 0x0F) == CEC_BR;
+    return cec_txq_push(bytes, len, broadcast ? CEC_TXQ_PRIO_BROADCAST : CEC_TXQ_PRIO_REPLY, tag);
+}
+
+// Report Physical Address (broadcast)
+static bool tx_report_physical_addr(void) {
+    uint8_t m[] = { hdr(CEC_LA, CEC_BR), CEC_OP_REPORT_PHYSICAL_ADDRESS,
+                    CEC_PHYS_ADDR_HI, CEC_PHYS_ADDR_LO, 0x05 };
+    return cec_tx_queue_led(m, sizeof m, "Report Physical Address");
+}
+
+// Device Vendor ID (broadcast) — vendor = 0x000000 (unknown)
+static bool tx_device_vendor_id(void) {
+    uint8_t m[] = { hdr(CEC_LA, CEC_BR), CEC_OP_DEVICE_VENDOR_ID,
+                    0x00, 0x00, 0x00 };
+    return cec_tx_queue_led(m, sizeof m, "Device Vendor ID");
+}
+
+// Set OSD Name
+static bool tx_set_osd_name(uint8_t dst, const char *name) {
+    uint8_t m[16];
+    uint8_t n = 0;
+    m[n++] = hdr(CEC_LA, dst);
+    m[n++] = CEC_OP_SET_OSD_NAME;
+    while (*name && n < sizeof m) {
+        m[n++] = (uint8_t)*name++;
+    }
+    return cec_tx_queue_led(m, n, "Set OSD Name");
+}
+
+// CEC Version — 1.4 = 0x05
+static bool tx_cec_version(uint8_t dst) {
+    uint8_t m[] = { hdr(CEC_LA, dst), CEC_OP_CEC_VERSION, 0x05 };
+    return cec_tx_queue_led(m, sizeof m, "CEC Version");
+}
+
+// Report Power Status — 0x00=ON, 0x01=Standby
+static bool tx_report_power_status(uint8_t dst) {
+    uint8_t m[] = { hdr(CEC_LA, dst), CEC_OP_REPORT_POWER_STATUS,
+                    (uint8_t)(g_state.power_on ? 0x00 : 0x01) };
+    return cec_tx_queue_led(m, sizeof m, "Report Power Status");
+}
+
+// Feature Abort
+static bool tx_feature_abort(uint8_t dst, uint8_t opcode, uint8_t reason) {
+    uint8_t m[] = { hdr(CEC_LA, dst), CEC_OP_FEATURE_ABORT, opcode, reason };
+    return cec_tx_queue_led(m, sizeof m, "Feature Abort");
+}
+
+// Set System Audio Mode (broadcast)
+static bool tx_set_system_audio_mode(bool on) {
+    uint8_t m[] = { hdr(CEC_LA, CEC_BR), CEC_OP_SET_SYSTEM_AUDIO_MODE,
+                    on ? 0x01 : 0x00 };
+    return cec_tx_queue_led(m, sizeof m, "Set System Audio Mode");
+}
+
+// System Audio Mode Status (directed)
+static bool tx_system_audio_mode_status(uint8_t dst, bool on) {
+    uint8_t m[] = { hdr(CEC_LA, dst), CEC_OP_SYSTEM_AUDIO_MODE_STATUS,
+                    on ? 0x01 : 0x00 };
+    return cec_tx_queue_led(m, sizeof m, "System Audio Mode Status");
+}
+
+static inline uint8_t audio_status_byte(const device_state_t *s) {
+    return (uint8_t)((s->mute ? 0x80 : 0x00) | (s->volume & 0x7F));
+}
+
+// Report Audio Status (directed)
+static bool tx_report_audio_status(uint8_t dst) {
+    uint8_t status = audio_status_byte(&g_state);
+    uint8_t m[] = { hdr(CEC_LA, dst), CEC_OP_REPORT_AUDIO_STATUS, status };
+    bool ok = cec_tx_queue_led(m, sizeof m, "Report Audio Status");
+    // キューに積めなければ audio_dirty を残し、audio_status_service が次の間隔で再送する
+    if (ok && dst == CEC_ADDR_TV) {
+        g_state.audio_reported = status;
+        g_state.audio_dirty    = false;
+    }
+    return ok;
+}
+
+// ---- 音量 / ミュート変化の通知 ----
+// System Audio Mode 中は TV の音量表示がこちらの状態を映すので、変化のたびに TV へ
+// Report Audio Status を送る (TV のポーリングを待たない)。間隔は AUDIO_REPORT_INTERVAL_MS 以上空け、
+// その間の変化 (ランプの各ステップ等) はまとめて最新値だけ送る。
+
+static void audio_status_changed(device_state_t *s) {
+    s->audio_dirty = true;
+}
+
+static void audio_status_service(device_state_t *s) {
+    if (!s->audio_dirty) {
+        return;
+    }
+    // TV のスタンバイはトポロジキャッシュで判断する (復帰時は TV が Give Audio Status で取りに来る)
+    uint8_t tv = cec_topo_tv_power();
+    bool tv_standby = tv == CEC_POWER_STANDBY || tv == CEC_POWER_TO_STANDBY;
+    if (!s->system_audio_mode || tv_standby || !cec_la_claimed() || audio_status_byte(s) == s->audio_reported) {
+        s->audio_dirty = false;   // TV は表示していない / 送れない / 既に同じ値を通知済み
+        return;
+    }
+    absolute_time_t now = get_absolute_time();
+    if (!is_nil_time(s->audio_next) && absolute_time_diff_us(now, s->audio_next) > 0) {
+        return;
+    }
+    LOG_D("=> Audio Status vol=%u mute=%u\n", s->volume, s->mute ? 1 : 0);
+    tx_report_audio_status(CEC_ADDR_TV);
+    s->audio_next = delayed_by_ms(now, AUDIO_REPORT_INTERVAL_MS);
+}
+
+// ---- RI アクションヘルパー ----
+
+// RI TX ラッパー (LED フラッシュ付き)
+// RI 送信は PIO + DMA が送出するのでブロックしない (CEC 応答を待たせない)
+static bool ri_tx_send_led(ri_cmd_t cmd) {
+    led_flash(LED_CH_RI_TX);
+    return ri_tx_send(cmd);
+}
+
+// 本体のボタンや電源断で切られた場合は RI に何も出ないことがある。
+// RI 受信がしばらく途絶えたら power_seen を落とし、次の電源 ON は通常の手順で送る
+static void power_seen_expire(device_state_t *s) {
+    if (s->power_seen
+        && absolute_time_diff_us(s->ri_seen_at, get_absolute_time()) > (int64_t)RI_SEEN_TIMEOUT_MS * 1000) {
+        LOG_D("  RI power state expired (no RI for %u s)\n", RI_SEEN_TIMEOUT_MS / 1000);
+        s->power_seen = false;
+    }
+}
+
+static void ri_power_off(device_state_t *s) {
+    s->power_seen = false;   // Standby を受けたら確認済みの状態は捨てる (デバウンス中も)
+    if (is_nil_time(s->last_off)
+        || absolute_time_diff_us(s->last_off, get_absolute_time()) > RI_DEBOUNCE_US) {
+        LOG_I("=> RI Power OFF\n");
+        ri_tx_send_led(RI_CMD_POWER_OFF);
+        s->last_off          = get_absolute_time();
+        s->power_on          = false;
+        s->system_audio_mode = false;
+    } else {
+        LOG_D("=> RI Power OFF suppressed (debounce)\n");
+    }
+}
+
+static void ri_power_on(device_state_t *s, const char *tag) {
+    power_seen_expire(s);
+    if (s->power_on && s->power_seen) {
+        // RI 受信でアンプの電源 ON を確認済み — 入力切替だけ送る
+        LOG_I("=> RI Input Sel%s (amp already on)\n", tag ? tag : "");
+        ri_tx_send_led(RI_CMD_INPUT_SEL);
+        return;
+    }
+    if (is_nil_time(s->last_on)
+        || absolute_time_diff_us(s->last_on, get_absolute_time()) > RI_DEBOUNCE_US) {
+        LOG_I("=> RI Power ON%s\n", tag ? tag : "");
+        ri_tx_send_led(RI_CMD_POWER_ON);
+        ri_tx_delay_ms(RI_INPUT_SEL_DELAY_MS);
+        LOG_I("=> RI Input Sel\n");
+        ri_tx_send_led(RI_CMD_INPUT_SEL);
+        s->last_on  = get_absolute_time();
+        s->power_on = true;
+    }
+}
+
+// 絶対音量の目標を設定 — 送出中のランプがあれば目標を差し替える
+static void volume_ramp_set(device_state_t *s, uint8_t target) {
+    s->vol_target     = target;
+    s->vol_ramp_start = get_absolute_time();
+    s->mute           = false;
+    if (!s->vol_ramp) {
+        s->vol_ramp = true;
+        s->vol_next = s->vol_ramp_start;
+    }
+    LOG_I("=> RI volume ramp %u -> %u (step %u)\n", s->volume, target, RI_VOL_STEP);
+}
+
+// メインループで毎周期呼ぶ — 間隔を空けて RI Vol Up / Down を 1 ステップずつ送る
+static void volume_ramp_service(device_state_t *s) {
+    if (!s->vol_ramp) {
+        return;
+    }
+    absolute_time_t now = get_absolute_time();
+    if (absolute_time_diff_us(now, s->vol_next) > 0) {
+        return;
+    }
+
+    int diff = (int)s->vol_target - (int)s->volume;
+    audio_status_changed(s);
+    if (diff >= RI_VOL_STEP) {
+        s->volume += RI_VOL_STEP;
+        ri_tx_send_led(RI_CMD_VOL_UP);
+    } else if (diff <= -RI_VOL_STEP) {
+        s->volume -= RI_VOL_STEP;
+        ri_tx_send_led(RI_CMD_VOL_DOWN);
+    } else {
+        // 1 ステップ未満の差は目標に丸める
+        s->volume   = s->vol_target;
+        s->vol_ramp = false;
+        uint32_t ms = (uint32_t)(absolute_time_diff_us(s->vol_ramp_start, now) / 1000);
+        if (ms > s->vol_lat_max_ms) {
+            s->vol_lat_max_ms = ms;
+        }
+        LOG_I("=> RI volume %u reached in %lu ms (max %lu ms)\n",
+               s->volume, (unsigned long)ms, (unsigned long)s->vol_lat_max_ms);
+        return;
+    }
+    s->vol_next = delayed_by_ms(now, RI_VOL_BURST_INTERVAL_MS);
+}
+
+static void ri_set_mute(device_state_t *s, bool mute) {
+    s->mute = mute;
+    audio_status_changed(s);
+    if (mute) {
+        LOG_I("=> RI Mute\n");
+        ri_tx_send_led(RI_CMD_MUTE);
+    } else {
+        LOG_I("=> RI Unmute\n");
+        ri_tx_send_led(RI_CMD_UNMUTE);
+    }
+}
+
+// ---- CEC フレーム処理 ----
+
+static void handle_cec_frame(const cec_frame_t *f, device_state_t *s) {
+    // CEC RX インジケータ
+    led_flash(LED_CH_CEC_RX);
+
+    // ログ出力
+    stall_enter(STALL_SITE_LOG);
+    LOG_I("CEC RX len=%u:", f->len);
+    for (uint8_t i = 0; i < f->len; i++) {
+        LOG_I(" %02X", f->bytes[i]);
+    }
+    LOG_I("\n");
+    stall_leave();
+
+    // トポロジキャッシュ更新 (全フレームから受動的に収集)
+    cec_topo_observe(f);
+
+    if (f->len < 2) {
+        LOG_D("  polling\n\n");
+        return;
+    }
+
+    uint8_t header = f->bytes[0];
+    uint8_t opcode = f->bytes[1];
+    uint8_t src = (header >> 4) & 0x0F;
+    uint8_t dst = header & 0x0F;
+
+    LOG_D("  opcode=0x%02X (%s) src=%u dst=%u\n", opcode, cec_opcode_name(opcode), src, dst);
+
+    // ======== Broadcast メッセージ ========
+    if (dst == CEC_BR) {
+        if (opcode == CEC_OP_STANDBY) {
+            ri_power_off(s);
+        }
+        LOG_D("\n");
+        return;
+    }
+
+    // ======== 自分宛て以外は無視 ========
+    // 論理アドレスを確保していない間は自分宛てではない (使用中なら持ち主の機器宛て)
+    if (dst != CEC_LA || !cec_la_claimed()) {
+        LOG_D("  (not for us)\n\n");
+        return;
+    }
+
+    // ======== 自分宛て メッセージ ========
+    bool handled = true;
+
+    switch (opcode) {
+
+    case CEC_OP_FEATURE_ABORT: // Feature Abort (受信)
+        if (f->len >= 4) {
+            LOG_I("  Remote Feature Abort: opcode=0x%02X reason=0x%02X\n", f->bytes[2], f->bytes[3]);
+        }
+        break;
+
+    // ---- 基本情報応答 (全CEC機器共通) ----
+
+    case CEC_OP_GIVE_PHYSICAL_ADDRESS:
+        tx_report_physical_addr();
+        break;
+
+    case CEC_OP_GIVE_OSD_NAME:
+        tx_set_osd_name(src, "OnkyoRI-Bridge");
+        break;
+
+    case CEC_OP_GET_CEC_VERSION:
+        tx_cec_version(src);
+        break;
+
+    case CEC_OP_GIVE_DEVICE_POWER_STATUS:
+        tx_report_power_status(src);
+        LOG_D("  Power Status: %s\n", s->power_on ? "ON" : "Standby");
+        break;
+
+    case CEC_OP_GIVE_DEVICE_VENDOR_ID:
+        tx_device_vendor_id();
+        break;
+
+    // ---- System Audio Control ----
+
+    case CEC_OP_SYSTEM_AUDIO_MODE_REQUEST: {
+        // オペランドあり → ON, なし → OFF
+        bool on = (f->len >= 4);
+        s->system_audio_mode = on;
+        tx_set_system_audio_mode(on);
+        LOG_D("  System Audio Mode Request -> %s\n", on ? "ON" : "OFF");
+
+        // SAM ON = TVがオーディオ出力先としてこのデバイスを使う → 電源ON
+        if (on && !s->power_on) {
+            ri_power_on(s, " [SAM]");
+        }
+        break;
+    }
+
+    case CEC_OP_SET_SYSTEM_AUDIO_MODE: // directed to us
+        if (f->len >= 3) {
+            s->system_audio_mode = (f->bytes[2] != 0);
+            LOG_D("  System Audio Mode = %u\n", s->system_audio_mode ? 1 : 0);
+            tx_system_audio_mode_status(src, s->system_audio_mode);
+        }
+        break;
+
+    case CEC_OP_GIVE_SYSTEM_AUDIO_MODE_STATUS:
+        tx_system_audio_mode_status(src, s->system_audio_mode);
+        LOG_D("  System Audio Mode = %u\n", s->system_audio_mode ? 1 : 0);
+        break;
+
+    case CEC_OP_GIVE_AUDIO_STATUS:
+        tx_report_audio_status(src);
+        LOG_D("  Audio Status: vol=%u mute=%u\n", s->volume, s->mute ? 1 : 0);
+        break;
+
+    case CEC_OP_SET_AUDIO_VOLUME_LEVEL: { // CEC 2.0
+        if (f->len >= 3) {
+            uint8_t new_vol = f->bytes[2] & 0x7F;
+            if (new_vol > 100) {
+                new_vol = 100;
+            }
+            volume_ramp_set(s, new_vol);
+        }
+        break;
+    }
+
+    // ---- User Control (音量連動) ----
+
+    case CEC_OP_USER_CONTROL_PRESSED:
+        if (f->len >= 3) {
+            uint8_t ui = f->bytes[2];
+            switch (ui) {
+            case 0x41: // Volume Up
+                s->vol_ramp = false;  // 手動操作はランプより優先
+                s->volume = (uint8_t)(s->volume + RI_VOL_STEP > 100 ? 100 : s->volume + RI_VOL_STEP);
+                s->mute = false;
+                LOG_I("=> RI Vol Up vol=%u\n", s->volume);
+                ri_tx_send_led(RI_CMD_VOL_UP);
+                audio_status_changed(s);
+                break;
+            case 0x42: // Volume Down
+                s->vol_ramp = false;
+                s->volume = (uint8_t)(s->volume < RI_VOL_STEP ? 0 : s->volume - RI_VOL_STEP);
+                s->mute = false;
+                LOG_I("=> RI Vol Down vol=%u\n", s->volume);
+                ri_tx_send_led(RI_CMD_VOL_DOWN);
+                audio_status_changed(s);
+                break;
+            case 0x43: // Mute Toggle
+                ri_set_mute(s, !s->mute);
+                break;
+            case 0x65: // Mute Function (ミュートON)
+                ri_set_mute(s, true);
+                break;
+            case 0x66: // Restore Volume (ミュート解除)
+                ri_set_mute(s, false);
+                break;
+            case 0x40: // Power
+            case 0x6C: // Power Off
+                ri_power_off(s);
+                break;
+            case 0x6B: // Power On
+                ri_power_on(s, "");
+                break;
+            default:
+                LOG_D("  UI command 0x%02X: not mapped\n", ui);
+                break;
+            }
+        }
+        break;
+
+    case CEC_OP_USER_CONTROL_RELEASED:
+        // 特に処理不要
+        break;
+
+    // ---- Standby (directed) ----
+
+    case CEC_OP_STANDBY:
+        ri_power_off(s);
+        break;
+
+    // ---- Abort (テスト用) ----
+
+    case CEC_OP_ABORT:
+        tx_feature_abort(src, CEC_OP_ABORT, CEC_ABORT_REFUSED);
+        break;
+
+    default:
+        handled = false;
+        break;
+    }
+
+    // 未対応 opcode → Feature Abort を返す
+    if (!handled) {
+        LOG_D("  0x%02X unrecognized\n", opcode);
+        tx_feature_abort(src, opcode, CEC_ABORT_UNRECOGNIZED);
+    }
+
+    LOG_D("\n");
+}
+
+// ---- 公開 API ----
+
+void bridge_announce(void) {
+    tx_report_physical_addr();
+    tx_device_vendor_id();
+}
+
+void bridge_handle_frame(const cec_frame_t *f) {
+    // ACK が相手に届かず再送された受理済みフレームは一度だけ処理する
+    if (cec_dedup_is_retransmission(f)) {
+        LOG_D("CEC RX len=%u: retransmission dropped\n", f->len);
+        return;
+    }
+    handle_cec_frame(f, &g_state);
+}
+
+void bridge_ri_received(ri_cmd_t cmd) {
+    device_state_t *s = &g_state;
+    LOG_I("<= RI %s\n", ri_cmd_name(cmd));
+    s->ri_seen_at = get_absolute_time();
+
+    switch (cmd) {
+    case RI_CMD_POWER_ON:
+        s->power_on   = true;
+        s->power_seen = true;
+        break;
+    case RI_CMD_POWER_OFF:
+        s->power_on   = false;
+        s->power_seen = true;
+        s->vol_ramp   = false;
+        if (s->system_audio_mode) {
+            // アンプ側で電源を切られた — TV にスピーカーを戻させる
+            s->system_audio_mode = false;
+            tx_set_system_audio_mode(false);
+        }
+        break;
+    case RI_CMD_VOL_UP:
+        s->volume = (uint8_t)(s->volume + RI_VOL_STEP > 100 ? 100 : s->volume + RI_VOL_STEP);
+        audio_status_changed(s);
+        break;
+    case RI_CMD_VOL_DOWN:
+        s->volume = (uint8_t)(s->volume < RI_VOL_STEP ? 0 : s->volume - RI_VOL_STEP);
+        audio_status_changed(s);
+        break;
+    case RI_CMD_MUTE:
+        s->mute = true;
+        audio_status_changed(s);
+        break;
+    case RI_CMD_UNMUTE:
+        s->mute = false;
+        audio_status_changed(s);
+        break;
+    default:
+        break;
+    }
+}
+
+void bridge_service(void) {
+    volume_ramp_service(&g_state);
+    audio_status_service(&g_state);
+    power_seen_expire(&g_state);
+}
+
+bool bridge_busy(void) {
+    return g_state.vol_ramp || g_state.audio_dirty;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <stdbool.h>
+#include "cec/cec_rx.h"
+#include "cec/cec_opcode.h"
+#include "ri/ri_proto.h"
+
+// CEC → RI 変換ロジック (デバイス状態 + フレームハンドラ)
+// ハードウェアには cec_txq / ri_tx / led / stall 経由でしか触れないので、
+// ホスト用リプレイツール (tools/cec_replay) からもそのままリンクできる。
+
+// 自分の論理アドレス
+#define BRIDGE_LA CEC_ADDR_AUDIO_SYSTEM
+
+// ブートアナウンス (Report Physical Address + Device Vendor ID) を送信キューに積む
+void bridge_announce(void);
+
+// 受信フレーム1つを処理 (応答は送信キュー、RI は ri_tx へ)
+void bridge_handle_frame(const cec_frame_t *f);
+
+// RI 受信したコマンドで状態 (電源 / 音量 / ミュート) を更新
+void bridge_ri_received(ri_cmd_t cmd);
+
+// メインループで毎周期呼ぶ — 絶対音量ランプの RI ステップ送出と、音量 / ミュート変化の TV への通知
+void bridge_service(void);
+
+// 音量ランプ送出中 / 未通知の音量変化があれば true
+bool bridge_busy(void);
@@ -0,0 +1,180 @@
+#include "cec_bist.h"
+#include "cec_tx.h"
+#include "cec_tx_cache.h"
+#include "cec_rx.h"
+#include "cec_timing.h"
+#include "pico/stdlib.h"
+#include "log.h"
+
+#define CEC_BIST_GAP_MS     10   // ポーリング間隔 (信号フリー時間 7 ビット期間以上)
+#define CEC_BIST_SYMBOLS    11   // start + データ 8 + EOM + ACK
+
+typedef enum {
+    BIST_START_LOW = 0,
+    BIST_START_HIGH,
+    BIST_BIT0_LOW,
+    BIST_BIT0_HIGH,
+    BIST_BIT1_LOW,
+    BIST_BIT1_HIGH,
+    BIST_COUNT
+} bist_item_t;
+
+typedef struct {
+    const char *name;
+    uint16_t    nominal_us;
+    uint16_t    tol_us;      // 仕様の許容範囲 (公称値 ± tol)
+} bist_spec_t;
+
+// LOW は仕様の ±200 µs、HIGH はビット周期 (2.05〜2.75 ms / start 4.3〜4.7 ms) から
+static const bist_spec_t k_spec[BIST_COUNT] = {
+    [BIST_START_LOW]  = { "start LOW",  CEC_T_START_LOW,  200 },
+    [BIST_START_HIGH] = { "start HIGH", CEC_T_START_HIGH, 200 },
+    [BIST_BIT0_LOW]   = { "bit0 LOW",   CEC_T_BIT0_LOW,   200 },
+    [BIST_BIT0_HIGH]  = { "bit0 HIGH",  CEC_T_BIT0_HIGH,  350 },
+    [BIST_BIT1_LOW]   = { "bit1 LOW",   CEC_T_BIT1_LOW,   200 },
+    [BIST_BIT1_HIGH]  = { "bit1 HIGH",  CEC_T_BIT1_HIGH,  350 },
+};
+
+typedef struct {
+    uint32_t n;
+    uint32_t sum;
+    uint16_t min;
+    uint16_t max;
+} bist_acc_t;
+
+static void bist_add(bist_acc_t *a, uint16_t us) {
+    if (us == 0) {
+        return;   // HIGH が記録されなかった (バスがアイドルに戻った)
+    }
+    if (a->n == 0 || us < a->min) {
+        a->min = us;
+    }
+    if (a->n == 0 || us > a->max) {
+        a->max = us;
+    }
+    a->n++;
+    a->sum += us;
+}
+
+// ポーリング 1 回分のシンボルを集計 (ACK スロットは相手次第なので除外)
+static void bist_collect(bist_acc_t *acc, const cec_rx_sym_t *sym, uint n, uint8_t header) {
+    if (n < CEC_BIST_SYMBOLS - 1) {
+        return;
+    }
+    bist_add(&acc[BIST_START_LOW], sym[0].low_us);
+    bist_add(&acc[BIST_START_HIGH], sym[0].high_us);
+    for (uint i = 1; i < CEC_BIST_SYMBOLS - 1; i++) {
+        // 1..8 = データ (MSB first)、9 = EOM (ヘッダのみのフレームなので 1)
+        bool one = i == 9 || ((header >> (8 - i)) & 1u);
+        bist_add(&acc[one ? BIST_BIT1_LOW : BIST_BIT0_LOW], sym[i].low_us);
+        bist_add(&acc[one ? BIST_BIT1_HIGH : BIST_BIT0_HIGH], sym[i].high_us);
+    }
+}
+
+// 実行中の試験
+static bool            g_running;
+static uint8_t         g_la;
+static uint8_t         g_header;
+static bist_acc_t      g_acc[BIST_COUNT];
+static uint            g_sent;
+static uint            g_acked;
+static absolute_time_t g_next;       // 次のポーリングを送ってよい時刻
+static absolute_time_t g_deadline;
+static cec_bist_done_t g_done;
+static int             g_slot;       // ポーリングの符号化済みワード列 (cec_tx_cache)
+
+// 集計を判定してログ出力
+static bool bist_report(void) {
+    const bist_acc_t *acc = g_acc;
+    LOG_I("CEC BIST: %u/%d polls of LA %u%s\n", g_sent, CEC_BIST_FRAMES, g_la,
+          g_acked ? " (ACKed by another device!)" : "");
+    if (g_sent == 0) {
+        LOG_W("CEC BIST: bus never idle, skipped\n");
+        return false;
+    }
+
+    bool pass = true;
+    for (int i = 0; i < BIST_COUNT; i++) {
+        const bist_spec_t *sp = &k_spec[i];
+        const bist_acc_t  *a  = &acc[i];
+        if (a->n == 0) {
+            LOG_W("  %-10s no samples\n", sp->name);
+            pass = false;
+            continue;
+        }
+        int32_t mean = (int32_t)(a->sum / a->n);
+        bool ok = a->min + sp->tol_us >= sp->nominal_us && a->max <= sp->nominal_us + sp->tol_us;
+        pass &= ok;
+        LOG_I("  %-10s n=%-3lu mean=%4ld (%+ld) min=%4u max=%4u jitter=%3u us  %s\n",
+              sp->name, (unsigned long)a->n, (long)mean, (long)(mean - sp->nominal_us),
+              a->min, a->max, (unsigned)(a->max - a->min), ok ? "ok" : "OUT OF SPEC");
+    }
+    if (pass) {
+        LOG_I("CEC BIST: PASS\n");
+    } else {
+        LOG_W("CEC BIST: FAIL\n");
+    }
+    return pass;
+}
+
+bool cec_bist_start(uint8_t la, cec_bist_done_t done) {
+    if (g_running) {
+        return false;
+    }
+    g_la       = (uint8_t)(la & 0x0F);
+    g_header   = (uint8_t)((g_la << 4) | g_la);
+    cec_tx_cache_kind_t kind;
+    g_slot     = cec_tx_cache_acquire(&g_header, 1, &kind);
+    if (g_slot < 0) {
+        LOG_W("CEC BIST: no free TX cache slot\n");
+        return false;
+    }
+    g_sent     = 0;
+    g_acked    = 0;
+    g_done     = done;
+    g_next     = make_timeout_time_ms(CEC_BIST_GAP_MS);
+    g_deadline = make_timeout_time_ms(CEC_BIST_TIMEOUT_MS);
+    for (int i = 0; i < BIST_COUNT; i++) {
+        g_acc[i] = (bist_acc_t){0};
+    }
+    g_running = true;
+    return true;
+}
+
+void cec_bist_service(void) {
+    if (!g_running) {
+        return;
+    }
+    absolute_time_t now = get_absolute_time();
+    bool timeout = absolute_time_diff_us(g_deadline, now) > 0;
+
+    // 間隔が空いていて他機器が送信中でなければ 1 回送る (送れなければ次の周期に再試行)
+    if (!timeout && absolute_time_diff_us(now, g_next) <= 0
+        && cec_rx_idle_us(CEC_BUS_MAIN) >= CEC_TX_IDLE_US) {
+        cec_rx_sym_t sym[CEC_BIST_SYMBOLS];
+        cec_rx_capture_start(CEC_BUS_MAIN, sym, CEC_BIST_SYMBOLS);
+        cec_tx_result_t r = cec_tx_send_bytes(CEC_BUS_MAIN, &g_header, 1, cec_tx_cache_words(g_slot));
+        uint n = cec_rx_capture_stop(CEC_BUS_MAIN);
+
+        if (r != CEC_TX_NOT_SENT) {
+            g_sent++;
+            g_acked += r == CEC_TX_OK;
+            bist_collect(g_acc, sym, n, g_header);
+        }
+        g_next = make_timeout_time_ms(CEC_BIST_GAP_MS);
+    }
+
+    if (g_sent < CEC_BIST_FRAMES && !timeout) {
+        return;
+    }
+    g_running = false;
+    cec_tx_cache_release(g_slot);
+    bool pass = bist_report();
+    if (g_done) {
+        g_done(pass);
+    }
+}
+
+bool cec_bist_busy(void) {
+    return g_running;
+}
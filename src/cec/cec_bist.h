@@ -0,0 +1,23 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+// CEC タイミング自己試験 (BIST)
+// 自分の論理アドレスへのポーリング (ヘッダ = la:la、他機器は ACK しない) を繰り返し送信し、
+// ループバックで RX が観測した start / bit0 / bit1 の LOW / HIGH 幅を cec_timing.h の公称値と比べる。
+// クロックや PIO 分周比のずれを現場で検出するためのもので、起動時とデバッグコンソールから実行する。
+// メインループで 1 周期にポーリング 1 回分 (約 30 ms) ずつ進めるので、その間も受信フレームを処理できる。
+
+#define CEC_BIST_FRAMES     8      // 送信するポーリング数
+#define CEC_BIST_TIMEOUT_MS 2000   // バスが空かない場合の打ち切り (送れた分で判定)
+
+// 完了通知: 全項目が許容範囲内なら pass = true
+typedef void (*cec_bist_done_t)(bool pass);
+
+// 試験を開始 (メインバス)。実行中か送信キャッシュに空きがなければ何もせず false。結果は完了時にログ出力して done を呼ぶ (NULL 可)
+bool cec_bist_start(uint8_t la, cec_bist_done_t done);
+
+// メインループで毎周期呼ぶ — 次のポーリングを送れるならシンボルを計測しながら 1 回送る
+void cec_bist_service(void);
+
+bool cec_bist_busy(void);
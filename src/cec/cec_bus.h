@@ -0,0 +1,9 @@
+#pragma once
+
+// CEC バス
+// cec_od / cec_rx / cec_tx はバスごとのコンテキスト (GPIO, PIO SM, 復号状態) を持ち、引数 bus (0..) で選ぶ。
+// 応答・送信するのはメインバスだけで、追加バスは受信専用 (モニタ)。
+// GPIO 割り込みは 1 つのハンドラ (cec_rx) が GPIO 番号からバスを引いて振り分ける。
+
+#define CEC_BUS_MAX  3   // 同時に扱えるバス数 (静的確保)
+#define CEC_BUS_MAIN 0   // bridge / 送信キュー / 較正 / 統計が使うバス
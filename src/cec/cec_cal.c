@@ -0,0 +1,199 @@
+#include "cec_cal.h"
+#include "cec_timing.h"
+#include "hot_path.h"
+#include <stdio.h>
+#include <string.h>
+
+// RX 受信判定窓の既定値 (µs) — TX タイミングに対して実測マージンを含む
+#define CEC_RX_BIT1_LOW_MIN     450
+#define CEC_RX_BIT1_LOW_MAX     950
+#define CEC_RX_BIT0_LOW_MIN    1200
+#define CEC_RX_BIT0_LOW_MAX    1900
+#define CEC_RX_START_LOW_MIN   3400
+#define CEC_RX_START_LOW_MAX   4200
+
+// ACK: 既定の保持時間 700 µs + 公称 bit1 LOW 600 µs = 実測で安定した ACK LOW 総幅
+#define CEC_CAL_ACK_HOLD_DEFAULT_US 700
+#define CEC_CAL_ACK_TOTAL_US        (CEC_T_BIT1_LOW + CEC_CAL_ACK_HOLD_DEFAULT_US)
+#define CEC_CAL_ACK_TOTAL_MAX_US    1650  // 仕様 bit0 LOW 上限 1.7 ms に余裕を持たせる
+#define CEC_CAL_ACK_SAMPLE_DEFAULT_US 1050
+
+// 仕様上の判定範囲 (µs)
+#define CEC_SPEC_SAMPLE_MIN     850   // データビットのサンプル位置 1.05 ms ± 0.2 ms
+#define CEC_SPEC_SAMPLE_MAX     1250
+#define CEC_SPEC_BIT1_LOW_MIN   300   // 受信側で許容する bit1 LOW の下限
+#define CEC_SPEC_BIT0_LOW_MAX   2050  // bit 期間の最小値
+
+#define CEC_CAL_LA_COUNT   16
+#define CEC_CAL_BIN_SHIFT  6                  // ヒストグラム幅 64 µs
+#define CEC_CAL_BINS       40                 // 0 〜 2560 µs (超過は最終ビン)
+#define CEC_CAL_MIN_SAMPLES 32                // 窓を調整し始めるサンプル数
+#define CEC_CAL_EMA_SHIFT  4                  // 平均の追従 (1/16)
+
+typedef struct {
+    uint16_t low_hist[CEC_CAL_BINS];
+    uint16_t high_hist[CEC_CAL_BINS];
+    uint32_t n1, n0, n_ack;
+    uint32_t avg1_x16, avg0_x16, ack_x16;   // 平均 (µs × 16)
+    cec_cal_win_t win;
+    uint16_t ack_hold_us;
+    uint16_t ack_sample_us;
+} cal_t;
+
+static const cec_cal_win_t k_default_win = {
+    .bit1_min  = CEC_RX_BIT1_LOW_MIN,  .bit1_max  = CEC_RX_BIT1_LOW_MAX,
+    .bit0_min  = CEC_RX_BIT0_LOW_MIN,  .bit0_max  = CEC_RX_BIT0_LOW_MAX,
+    .start_min = CEC_RX_START_LOW_MIN, .start_max = CEC_RX_START_LOW_MAX,
+};
+
+static cal_t g_cal[CEC_CAL_LA_COUNT];
+
+static inline uint32_t clamp_u32(uint32_t v, uint32_t lo, uint32_t hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static inline void HOT_FUNC(hist_add)(uint16_t *hist, uint32_t us) {
+    uint32_t bin = us >> CEC_CAL_BIN_SHIFT;
+    if (bin >= CEC_CAL_BINS) {
+        bin = CEC_CAL_BINS - 1;
+    }
+    if (hist[bin] != UINT16_MAX) {
+        hist[bin]++;
+    }
+}
+
+static inline void HOT_FUNC(ema_add)(uint32_t *avg_x16, uint32_t n, uint32_t us) {
+    int32_t x = (int32_t)(us << 4);
+    if (n == 1) {
+        *avg_x16 = (uint32_t)x;
+    } else {
+        *avg_x16 = (uint32_t)((int32_t)*avg_x16 + ((x - (int32_t)*avg_x16) >> CEC_CAL_EMA_SHIFT));
+    }
+}
+
+// 学習した平均から判定窓と ACK 保持時間を再計算
+static void HOT_FUNC(recompute)(cal_t *c) {
+    if (c->n1 < CEC_CAL_MIN_SAMPLES || c->n0 < CEC_CAL_MIN_SAMPLES) {
+        return;
+    }
+    uint32_t m1 = c->avg1_x16 >> 4;
+    uint32_t m0 = c->avg0_x16 >> 4;
+
+    // bit1 / bit0 の境界は平均の中点 (仕様のサンプル範囲内)
+    uint32_t thr = clamp_u32((m1 + m0) / 2, CEC_SPEC_SAMPLE_MIN, CEC_SPEC_SAMPLE_MAX);
+
+    cec_cal_win_t w = k_default_win;
+    w.bit1_min = (uint16_t)clamp_u32(m1 > 250 ? m1 - 250 : 0, CEC_SPEC_BIT1_LOW_MIN, CEC_RX_BIT1_LOW_MIN);
+    w.bit1_max = (uint16_t)(thr - 1);
+    w.bit0_min = (uint16_t)thr;
+    w.bit0_max = (uint16_t)clamp_u32(m0 + 300, CEC_RX_BIT0_LOW_MAX, CEC_SPEC_BIT0_LOW_MAX);
+    c->win = w;
+
+    // ACK LOW 総幅が既定と同じになるよう保持時間を補正 (仕様上限を超えない)
+    uint32_t total = CEC_CAL_ACK_TOTAL_US;
+    if (m1 + 100 > total) {
+        total = m1 + 100;
+    }
+    if (total > CEC_CAL_ACK_TOTAL_MAX_US) {
+        total = CEC_CAL_ACK_TOTAL_MAX_US;
+    }
+    c->ack_hold_us = (uint16_t)(total > m1 ? total - m1 : 100);
+}
+
+void cec_cal_init(void) {
+    memset(g_cal, 0, sizeof g_cal);
+    for (int i = 0; i < CEC_CAL_LA_COUNT; i++) {
+        g_cal[i].win = k_default_win;
+        g_cal[i].ack_hold_us = CEC_CAL_ACK_HOLD_DEFAULT_US;
+        g_cal[i].ack_sample_us = CEC_CAL_ACK_SAMPLE_DEFAULT_US;
+    }
+}
+
+const cec_cal_win_t *HOT_FUNC(cec_cal_window)(uint8_t initiator) {
+    if (initiator >= CEC_CAL_LA_COUNT) {
+        return &k_default_win;
+    }
+    return &g_cal[initiator].win;
+}
+
+void HOT_FUNC(cec_cal_record_low)(uint8_t initiator, uint32_t low_us, bool one) {
+    if (initiator >= CEC_CAL_LA_COUNT) {
+        return;
+    }
+    cal_t *c = &g_cal[initiator];
+    hist_add(c->low_hist, low_us);
+    if (one) {
+        ema_add(&c->avg1_x16, ++c->n1, low_us);
+    } else {
+        ema_add(&c->avg0_x16, ++c->n0, low_us);
+    }
+    if (((c->n1 + c->n0) & 7u) == 0) {
+        recompute(c);
+    }
+}
+
+void HOT_FUNC(cec_cal_record_high)(uint8_t initiator, uint32_t high_us) {
+    if (initiator >= CEC_CAL_LA_COUNT) {
+        return;
+    }
+    hist_add(g_cal[initiator].high_hist, high_us);
+}
+
+void HOT_FUNC(cec_cal_record_ack)(uint8_t follower, uint32_t low_us) {
+    if (follower >= CEC_CAL_LA_COUNT) {
+        return;
+    }
+    cal_t *c = &g_cal[follower];
+    ema_add(&c->ack_x16, ++c->n_ack, low_us);
+    if (c->n_ack >= CEC_CAL_MIN_SAMPLES / 4) {
+        // 自分の bit1 LOW 解放とフォロワーの ACK 解放の中点でサンプルする
+        uint32_t mid = (CEC_T_BIT1_LOW + (c->ack_x16 >> 4)) / 2;
+        c->ack_sample_us = (uint16_t)clamp_u32(mid, CEC_SPEC_SAMPLE_MIN, CEC_SPEC_SAMPLE_MAX);
+    }
+}
+
+uint32_t HOT_FUNC(cec_cal_ack_hold_us)(uint8_t initiator) {
+    if (initiator >= CEC_CAL_LA_COUNT) {
+        return CEC_CAL_ACK_HOLD_DEFAULT_US;
+    }
+    return g_cal[initiator].ack_hold_us;
+}
+
+uint32_t cec_cal_ack_sample_us(uint8_t follower) {
+    if (follower >= CEC_CAL_LA_COUNT) {
+        return CEC_CAL_ACK_SAMPLE_DEFAULT_US;
+    }
+    return g_cal[follower].ack_sample_us;
+}
+
+static void dump_hist(const char *name, const uint16_t *hist) {
+    printf("    %s:", name);
+    for (int b = 0; b < CEC_CAL_BINS; b++) {
+        if (hist[b]) {
+            printf(" %u:%u", (unsigned)(b << CEC_CAL_BIN_SHIFT), hist[b]);
+        }
+    }
+    printf("\n");
+}
+
+void cec_cal_dump(void) {
+    printf("CEC timing calibration (default: bit1 %u-%u, bit0 %u-%u, ack hold %u, ack sample %u us)\n",
+           k_default_win.bit1_min, k_default_win.bit1_max, k_default_win.bit0_min, k_default_win.bit0_max,
+           CEC_CAL_ACK_HOLD_DEFAULT_US, CEC_CAL_ACK_SAMPLE_DEFAULT_US);
+    for (int la = 0; la < CEC_CAL_LA_COUNT; la++) {
+        const cal_t *c = &g_cal[la];
+        if (c->n1 + c->n0 + c->n_ack == 0) {
+            continue;
+        }
+        printf("  LA %2d: n1=%lu avg1=%lu n0=%lu avg0=%lu -> bit1 %u-%u bit0 %u-%u ack hold %u us\n", la,
+               (unsigned long)c->n1, (unsigned long)(c->avg1_x16 >> 4),
+               (unsigned long)c->n0, (unsigned long)(c->avg0_x16 >> 4),
+               c->win.bit1_min, c->win.bit1_max, c->win.bit0_min, c->win.bit0_max, c->ack_hold_us);
+        if (c->n_ack) {
+            printf("         as follower: ack LOW avg=%lu (n=%lu) -> TX ack sample %u us\n",
+                   (unsigned long)(c->ack_x16 >> 4), (unsigned long)c->n_ack, c->ack_sample_us);
+        }
+        dump_hist("LOW ", c->low_hist);
+        dump_hist("HIGH", c->high_hist);
+    }
+}
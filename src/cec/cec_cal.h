@@ -0,0 +1,41 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+// CEC タイミング自動較正
+// 受信した波形の LOW / HIGH 幅をイニシエータごとにヒストグラム化し、平均から
+// ビット判定窓と ACK 保持時間を仕様の範囲内で調整する。
+// 送信時の ACK サンプル位置は、ループバックで観測した宛先フォロワーの ACK LOW 幅から決める。
+// 記録・参照関数は RX ISR から呼ばれる。
+
+#define CEC_CAL_NO_LA 0xFF
+
+// LOW 幅による判定窓 (µs)
+typedef struct {
+    uint16_t bit1_min, bit1_max;
+    uint16_t bit0_min, bit0_max;
+    uint16_t start_min, start_max;
+} cec_cal_win_t;
+
+void cec_cal_init(void);
+
+// イニシエータの判定窓 (学習前 / 不明なら既定値)
+const cec_cal_win_t *cec_cal_window(uint8_t initiator);
+
+// データビット 1 つ分の LOW 幅 (one = 判定結果)
+void cec_cal_record_low(uint8_t initiator, uint32_t low_us, bool one);
+
+// データビット後の HIGH 幅
+void cec_cal_record_high(uint8_t initiator, uint32_t high_us);
+
+// ループバックで観測した宛先フォロワーの ACK LOW 幅
+void cec_cal_record_ack(uint8_t follower, uint32_t low_us);
+
+// そのイニシエータへ ACK するときの保持時間 (立ち上がり検出から解放まで)
+uint32_t cec_cal_ack_hold_us(uint8_t initiator);
+
+// 送信時の ACK サンプル位置 (ACK シンボル開始から)
+uint32_t cec_cal_ack_sample_us(uint8_t follower);
+
+// 学習値とヒストグラムを出力
+void cec_cal_dump(void);
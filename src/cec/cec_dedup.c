@@ -0,0 +1,66 @@
+#include "cec_dedup.h"
+#include <stdio.h>
+#include <string.h>
+#include "cec_opcode.h"
+
+typedef struct {
+    uint8_t  len;                          // 0 = 未記録
+    uint8_t  bytes[CEC_MAX_FRAME_BYTES];
+    uint32_t end_us;
+} dedup_last_t;
+
+typedef struct {
+    uint32_t checked;
+    uint32_t dropped;
+    uint32_t gap_min_us;                   // 破棄した再送の間隔
+    uint32_t gap_max_us;
+    uint8_t  last_len;                     // 最後に破棄したフレーム (1 = ポーリング)
+    uint8_t  last_opcode;
+} dedup_stats_t;
+
+static dedup_last_t  g_last[16];           // イニシエータ (論理アドレス) ごと
+static dedup_stats_t g_stats;
+
+bool cec_dedup_is_retransmission(const cec_frame_t *f) {
+    if (f->len == 0) {
+        return false;
+    }
+    dedup_last_t *l = &g_last[f->bytes[0] >> 4];
+    g_stats.checked++;
+
+    uint32_t gap = f->start_us - l->end_us;
+    bool dup = f->acked && l->len == f->len && gap < CEC_DEDUP_WINDOW_US
+            && memcmp(l->bytes, f->bytes, f->len) == 0;
+
+    // 再送が続いても直前の 1 回から測る
+    l->len = f->acked ? f->len : 0;
+    memcpy(l->bytes, f->bytes, f->len);
+    l->end_us = f->end_us;
+
+    if (dup) {
+        if (g_stats.dropped == 0 || gap < g_stats.gap_min_us) {
+            g_stats.gap_min_us = gap;
+        }
+        if (gap > g_stats.gap_max_us) {
+            g_stats.gap_max_us = gap;
+        }
+        g_stats.dropped++;
+        g_stats.last_len = f->len;
+        g_stats.last_opcode = f->len > 1 ? f->bytes[1] : 0;
+    }
+    return dup;
+}
+
+void cec_dedup_dump(void) {
+    printf("CEC dedup: checked=%lu dropped=%lu", (unsigned long)g_stats.checked,
+           (unsigned long)g_stats.dropped);
+    if (g_stats.dropped) {
+        printf(" gap=%lu..%lu us last=", (unsigned long)g_stats.gap_min_us, (unsigned long)g_stats.gap_max_us);
+        if (g_stats.last_len == 1) {
+            printf("poll");
+        } else {
+            printf("%s (0x%02X)", cec_opcode_name(g_stats.last_opcode), g_stats.last_opcode);
+        }
+    }
+    printf(" (window %lu ms)\n", (unsigned long)(CEC_DEDUP_WINDOW_US / 1000));
+}
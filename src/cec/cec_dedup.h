@@ -0,0 +1,19 @@
+#pragma once
+#include <stdbool.h>
+#include "cec_rx.h"
+
+// 再送フレームの重複排除
+// 受理したフレームの ACK がイニシエータ側で NACK に見えると、同じフレームが再送されて
+// 二重に処理される (RI Vol Up が 2 ステップ進む、電源 ON シーケンスを再実行する等)。
+// イニシエータごとに直前のフレームを覚えておき、同じバイト列が短い間隔で届いたら再送とみなす。
+
+// 直前のフレームの終わりから次のフレームの始まりまでがこれ未満なら再送扱い。
+// 再送はシグナルフリー時間 (3 ビット期間 ≒ 7.2 ms) 後に始まり、
+// User Control Pressed のリピート (200 ms 以上間隔) より十分短い
+#define CEC_DEDUP_WINDOW_US 100000
+
+// 受理済みフレームの再送なら true (呼び出し側で捨てる)。それ以外は記録して false
+bool cec_dedup_is_retransmission(const cec_frame_t *f);
+
+// 統計 (検査数 / 破棄数 / 破棄した再送の間隔) を出力
+void cec_dedup_dump(void);
@@ -0,0 +1,108 @@
+#include "cec_la.h"
+#include "cec_txq.h"
+#include "cec_opcode.h"
+#include "log.h"
+#include "pico/stdlib.h"
+
+typedef enum {
+    LA_SETTLE = 0,   // バス安定待ち (g_next まで)
+    LA_POLLING,      // ポーリングを送信キューに積んだ — 完了待ち
+    LA_POLLED,       // ポーリング完了 — 結果を service で処理
+    LA_CLAIMED,
+    LA_IN_USE,       // unregistered で動作中 (g_next に再ポーリング)
+} la_state_t;
+
+static la_state_t        g_state;
+static uint8_t           g_la;
+static cec_tx_result_t   g_result;    // ポーリングの結果
+static bool              g_was_lost;  // 一度でも使用中と判定した
+static absolute_time_t   g_next;
+static cec_la_event_cb_t g_cb;
+
+static void la_poll_done(cec_tx_result_t result, void *ctx) {
+    (void)ctx;
+    // 送信キューの中から呼ばれるので、結果だけ残して処理は service で行う
+    g_result = result;
+    g_state = LA_POLLED;
+}
+
+// 自分の論理アドレスとしては ACK も応答もしない (確保前 / 使用中)
+static void la_set_unregistered(void) {
+    cec_rx_set_logical_addr(CEC_BUS_MAIN, CEC_ADDR_BROADCAST);
+    cec_rx_enable_ack(CEC_BUS_MAIN, false);
+}
+
+static void la_set_in_use(void) {
+    la_set_unregistered();
+    g_state = LA_IN_USE;
+    g_was_lost = true;
+    g_next = make_timeout_time_ms(CEC_LA_RECLAIM_MS);
+    LOG_W("CEC LA %u is in use! Falling back to unregistered (15), retry in %u s\n",
+          g_la, CEC_LA_RECLAIM_MS / 1000);
+    if (g_cb) {
+        g_cb(CEC_LA_EV_IN_USE, g_la);
+    }
+}
+
+static void la_set_claimed(void) {
+    cec_rx_set_logical_addr(CEC_BUS_MAIN, g_la);
+    cec_rx_enable_ack(CEC_BUS_MAIN, true);
+    g_state = LA_CLAIMED;
+    LOG_I("CEC LA %u is free, %s\n", g_la, g_was_lost ? "reclaimed" : "claimed");
+    if (g_cb) {
+        g_cb(CEC_LA_EV_CLAIMED, g_la);
+    }
+}
+
+void cec_la_init(uint8_t la, cec_la_event_cb_t cb) {
+    g_la = (uint8_t)(la & 0x0F);
+    g_cb = cb;
+    g_state = LA_SETTLE;
+    g_next = make_timeout_time_ms(CEC_LA_SETTLE_MS);
+    la_set_unregistered();
+}
+
+void cec_la_service(void) {
+    switch (g_state) {
+    case LA_SETTLE:
+    case LA_IN_USE: {
+        if (absolute_time_diff_us(get_absolute_time(), g_next) > 0) {
+            break;
+        }
+        // NACK = 空き。ACK = 他の機器が使用中
+        uint8_t poll = (uint8_t)((g_la << 4) | g_la);
+        if (cec_txq_push_cb(&poll, 1, CEC_TXQ_PRIO_REPLY, "LA Poll",
+                            CEC_LA_POLL_RETRIES, la_poll_done, NULL)) {
+            g_state = LA_POLLING;
+        }
+        break;
+    }
+    case LA_POLLED:
+        if (g_result == CEC_TX_OK) {
+            la_set_in_use();
+        } else if (g_result == CEC_TX_NACK) {
+            la_set_claimed();
+        } else {
+            // バス使用中 / 衝突で送れていない — 結果が出るまでポーリングし直す
+            LOG_D("CEC LA %u poll not sent, retrying\n", g_la);
+            g_state = g_was_lost ? LA_IN_USE : LA_SETTLE;
+            g_next = make_timeout_time_ms(CEC_LA_BUSY_RETRY_MS);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void cec_la_observe(const cec_frame_t *f) {
+    // 自分の送信はループバックなので届かない。ポーリング (1 バイト) は相手がアドレスを探しているだけ
+    if (g_state != LA_CLAIMED || f->len < 2 || (f->bytes[0] >> 4) != g_la) {
+        return;
+    }
+    LOG_W("CEC LA %u: frame from another device with our address\n", g_la);
+    la_set_in_use();
+}
+
+bool cec_la_claimed(void) {
+    return g_state == LA_CLAIMED;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "cec_rx.h"
+
+// 論理アドレスの確保 (メインバス)
+// メインループで回す状態機械。RX (ブロードキャストの受信) は起動直後から動かしたまま、
+// バス安定待ち → ポーリング (src=dst=la のヘッダのみ) を送信キュー経由で送る。
+// ポーリングの結果が出るまでは unregistered (15) — 自分の論理アドレスとして ACK も応答もしない。
+// NACK = 空き → 確保。ACK あり = 他の機器が使用中 → unregistered のまま、一定時間ごとに再ポーリングして取り戻す。
+// バス使用中 / 衝突で送れなかった場合は結果にせず、送れるまでポーリングし直す。
+// 確保後に同じ論理アドレスから他の機器のフレームが届いたら、失ったとみなして同じく再確保に回る。
+
+#define CEC_LA_SETTLE_MS     1000   // 起動後のバス安定待ち
+#define CEC_LA_POLL_RETRIES  1      // NACK のポーリングを再送してから空きと判断する回数
+#define CEC_LA_BUSY_RETRY_MS 100    // ポーリングを送れなかったときの再試行間隔
+#define CEC_LA_RECLAIM_MS    30000  // 使用中だった論理アドレスを再ポーリングするまでの間隔
+
+typedef enum {
+    CEC_LA_EV_CLAIMED = 0,   // 確保できた (初回 / 取り戻し)
+    CEC_LA_EV_IN_USE,        // 使用中だった / 失った — unregistered で動作中
+} cec_la_event_t;
+
+// 状態が変わるたびに cec_la_service() から呼ばれる
+typedef void (*cec_la_event_cb_t)(cec_la_event_t ev, uint8_t la);
+
+// RX は unregistered (ACK なし) で開始する。確保できたら la で ACK する
+void cec_la_init(uint8_t la, cec_la_event_cb_t cb);
+
+// メインループで毎周期呼ぶ (ブロックしない)
+void cec_la_service(void);
+
+// 受信フレームを渡す — 同じ論理アドレスを使う他の機器を検出する
+void cec_la_observe(const cec_frame_t *f);
+
+// 確保済みなら true。自分の論理アドレスとして応答 / 送信してよいのはこの間だけ
+bool cec_la_claimed(void);
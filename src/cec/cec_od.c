@@ -1,35 +1,36 @@
 #include "cec_od.h"
+#include "hot_path.h"
 
-static uint g_cec_gpio;
+static uint g_cec_gpio[CEC_BUS_MAX];
 
-void cec_od_init(uint gpio) {
-    g_cec_gpio = gpio;
+void cec_od_init(uint bus, uint gpio) {
+    g_cec_gpio[bus] = gpio;
 
-    gpio_init(g_cec_gpio);
+    gpio_init(gpio);
 
     // 初期状態は解放（Hi-Z）
-    gpio_set_dir(g_cec_gpio, false);
+    gpio_set_dir(gpio, false);
 
     // CECは基本プルアップが外部にあるが、テスト用に内部プルアップを有効にしておく
     // （外部プルアップを付けた場合でも大抵は問題にならない程度の弱さ）
-    gpio_pull_up(g_cec_gpio);
+    gpio_pull_up(gpio);
 }
 
-void cec_od_drive_low(void) {
+void HOT_FUNC(cec_od_drive_low)(uint bus) {
     // 出力Lowのみを使う（High出力は禁止）
-    gpio_put(g_cec_gpio, 0);
-    gpio_set_dir(g_cec_gpio, true);
+    gpio_put(g_cec_gpio[bus], 0);
+    gpio_set_dir(g_cec_gpio[bus], true);
 }
 
-void cec_od_release(void) {
+void HOT_FUNC(cec_od_release)(uint bus) {
     // 入力(Hi-Z)に戻す（外部プルアップでHighになる）
-    gpio_set_dir(g_cec_gpio, false);
+    gpio_set_dir(g_cec_gpio[bus], false);
 }
 
-bool cec_od_read(void) {
-    return gpio_get(g_cec_gpio);
+bool HOT_FUNC(cec_od_read)(uint bus) {
+    return gpio_get(g_cec_gpio[bus]);
 }
 
-uint cec_od_gpio(void) {
-    return g_cec_gpio;
+uint HOT_FUNC(cec_od_gpio)(uint bus) {
+    return g_cec_gpio[bus];
 }
@@ -1,13 +1,14 @@
 #pragma once
 #include <stdbool.h>
 #include "pico/stdlib.h"
+#include "cec_bus.h"
 
-// 擬似オープンドレイン：
+// 擬似オープンドレイン (バスごと)：
 // - drive_low(): 出力Lowでバスを引き下げ
 // - release() : 入力(Hi-Z)でバスを解放（Highはプルアップで上がる）
 
-void cec_od_init(uint gpio);
-void cec_od_drive_low(void);
-void cec_od_release(void);
-bool cec_od_read(void);
-uint cec_od_gpio(void);
+void cec_od_init(uint bus, uint gpio);
+void cec_od_drive_low(uint bus);
+void cec_od_release(uint bus);
+bool cec_od_read(uint bus);
+uint cec_od_gpio(uint bus);
@@ -2,6 +2,7 @@
 #include <stdint.h>
 
 // CEC logical addresses
+#define CEC_ADDR_TV            0x00
 #define CEC_ADDR_AUDIO_SYSTEM  0x05
 #define CEC_ADDR_BROADCAST     0x0F
 
@@ -1,182 +1,368 @@
 #include "cec_rx.h"
 #include "cec_od.h"
 #include "cec_timing.h"
+#include "cec_cal.h"
+#include "cec_stats.h"
+#include "cec_opcode.h"
+#include "hot_path.h"
+#include <stdio.h>
 #include <string.h>
 #include "pico/time.h"
 #include "hardware/sync.h"
+#include "hardware/structs/io_bank0.h"
 
-// RX 受信判定窓 (µs) — TX タイミングに対して実測マージンを含む
-#define CEC_RX_BIT1_LOW_MIN     450
-#define CEC_RX_BIT1_LOW_MAX     950
-#define CEC_RX_BIT0_LOW_MIN    1200
-#define CEC_RX_BIT0_LOW_MAX    1900
-#define CEC_RX_START_LOW_MIN   3400
-#define CEC_RX_START_LOW_MAX   4200
+// RX 受信判定窓は cec_cal が管理 (既定値 + イニシエータごとの学習値)。
+// 較正とバス統計はメインバスのみ — 他のバスは既定の判定窓で復号する。
 
 typedef enum { SYM_0=0, SYM_1=1, SYM_START=2, SYM_INVALID=3 } sym_t;
 
-static inline sym_t classify_low(uint32_t us) {
-    if (us >= CEC_RX_START_LOW_MIN && us <= CEC_RX_START_LOW_MAX) return SYM_START;
-    if (us >= CEC_RX_BIT0_LOW_MIN  && us <= CEC_RX_BIT0_LOW_MAX)  return SYM_0;
-    if (us >= CEC_RX_BIT1_LOW_MIN  && us <= CEC_RX_BIT1_LOW_MAX)  return SYM_1;
+static inline sym_t HOT_FUNC(classify_low)(uint32_t us, const cec_cal_win_t *w) {
+    if (us >= w->start_min && us <= w->start_max) return SYM_START;
+    if (us >= w->bit0_min  && us <= w->bit0_max)  return SYM_0;
+    if (us >= w->bit1_min  && us <= w->bit1_max)  return SYM_1;
     return SYM_INVALID;
 }
 
-// ---- ACK制御 ----
-static bool     g_ack_enabled = false;
-static uint8_t  g_logical_addr = 0x05;
-static volatile bool g_ack_holding = false;
-static alarm_id_t g_ack_alarm = -1;
-
-static volatile uint32_t g_ack_hold_us = 700;
-
-// ACK解放後の自己エッジを読み飛ばすフラグ
-static volatile bool g_skip_next_rise = false;
-
-static int64_t ack_release_cb(alarm_id_t id, void* user_data) {
-    (void)id; (void)user_data;
-    cec_od_release();
-    g_ack_holding = false;
-    g_ack_alarm = -1;
+// ---- バスごとの受信コンテキスト ----
+typedef struct {
+    bool     used;
+    bool     main;                 // CEC_BUS_MAIN (較正 / 統計 / レイテンシ計測の対象)
+    uint8_t  id;
+    uint     gpio;
+
+    // ACK制御
+    bool              ack_enabled;
+    uint8_t           logical_addr;
+    volatile bool     ack_holding;
+    alarm_id_t        ack_alarm;
+    volatile uint32_t ack_hold_us;
+    volatile bool     skip_next_rise;   // ACK解放後の自己エッジを読み飛ばす
+
+    // 自己送信ループバック
+    // TX 中も RX は動作し続け、自分の波形を復号して送信内容を検証する。
+    // ループバック中は ACK 応答とフレーム通知を抑止する。
+    volatile bool    loopback;
+    volatile uint8_t lb_len;
+    uint8_t          lb_bytes[CEC_MAX_FRAME_BYTES];
+
+    // 自己試験用シンボル記録
+    cec_rx_sym_t *volatile cap_buf;
+    uint                   cap_max;
+    volatile uint          cap_len;
+
+    // フレーム格納（ISR→main受け渡し）
+    volatile bool     frame_ready;
+    volatile uint8_t  frame_len;
+    volatile uint8_t  frame_bytes[CEC_MAX_FRAME_BYTES];
+    volatile bool     frame_acked;
+    volatile uint32_t frame_start_us;
+    volatile uint32_t frame_end_us;
+
+    // ISR内部の逐次復号状態
+    // タイムスタンプは 32 bit (time_us_32) — 差分のみ使うので折り返しは問題にならない
+    volatile uint32_t last_edge_us;
+    volatile bool     last_level;
+
+    uint8_t cur;
+    int     bitpos;                // 0..7 data, 8=EOM, 9=ACK slot
+    bool    eom;
+
+    uint8_t buf[CEC_MAX_FRAME_BYTES];
+    uint8_t len;
+    bool    in_frame;
+    bool    first_byte;
+    bool    addressed_to_us;       // 現フレームが自分宛てか
+    uint8_t header;
+
+    // タイミング較正
+    // イニシエータはヘッダの上位 4 ビットで判明する。それまでの LOW 幅は保留しておく。
+    uint8_t  src;
+    const cec_cal_win_t *win;      // 現フレームの判定窓
+    uint16_t pend_low[4];
+    uint8_t  pend_one;             // 保留ビットの判定結果 (bit n)
+    bool     high_valid;           // 次の立ち下がりで HIGH 幅を記録するか
+
+    // バス占有時間 (cec_stats)
+    uint32_t cur_start_us;         // スタートビットの立ち下がり
+    uint32_t cur_last_us;          // 最後に復号できたシンボルの終わり
+
+    // CPU 負荷 (このバスのエッジ処理に費やした時間)
+    volatile uint32_t isr_count;
+    volatile uint64_t isr_sum_us;
+    volatile uint32_t isr_max_us;
+    uint64_t          since_us;    // 計測開始 (cec_rx_init)
+} rx_bus_t;
+
+static rx_bus_t g_bus[CEC_BUS_MAX];
+
+static int64_t HOT_FUNC(ack_release_cb)(alarm_id_t id, void* user_data) {
+    (void)id;
+    rx_bus_t *b = (rx_bus_t *)user_data;
+    cec_od_release(b->id);
+    b->ack_holding = false;
+    b->ack_alarm = -1;
     return 0;
 }
 
-static inline void ack_hold_start(void) {
-    if (g_ack_holding) {
+static inline void HOT_FUNC(ack_hold_start)(rx_bus_t *b) {
+    if (b->ack_holding) {
         return;
     }
 
-    g_ack_holding = true;
-    cec_od_drive_low();
+    b->ack_holding = true;
+    cec_od_drive_low(b->id);
 
-    if (g_ack_alarm >= 0) {
-        cancel_alarm(g_ack_alarm);
-        g_ack_alarm = -1;
+    if (b->ack_alarm >= 0) {
+        cancel_alarm(b->ack_alarm);
+        b->ack_alarm = -1;
     }
 
-    g_ack_alarm = add_alarm_in_us((int64_t)g_ack_hold_us, ack_release_cb, NULL, true);
+    b->ack_alarm = add_alarm_in_us((int64_t)b->ack_hold_us, ack_release_cb, b, true);
 
     // ACK解放時の立ち上がりエッジをデータビットと誤認しないよう、
     // 次の立ち上がりエッジを1回読み飛ばす
-    g_skip_next_rise = true;
+    b->skip_next_rise = true;
 }
 
-// ---- フレーム格納（ISR→main受け渡し）----
-static volatile bool g_frame_ready = false;
-static volatile uint8_t g_frame_len = 0;
-static volatile uint8_t g_frame_bytes[CEC_MAX_FRAME_BYTES];
-
-// ---- ISR内部の逐次復号状態 ----
-static volatile uint64_t g_last_edge_us = 0;
-static volatile bool     g_last_level = true;
-
-static uint8_t s_cur = 0;
-static int     s_bitpos = 0;       // 0..7 data, 8=EOM, 9=ACK slot
-static bool    s_eom = false;
-
-static uint8_t s_buf[CEC_MAX_FRAME_BYTES];
-static uint8_t s_len = 0;
-static bool    s_in_frame = false;
-static bool    s_first_byte = true;
-static bool    s_addressed_to_us = false;  // 現フレームが自分宛てか
-static uint8_t s_header = 0;
+// ---- ISR レイテンシ計測 (メインバス) ----
+// GPIO 割り込みを強制発生させ (INTF)、発生から cec_irq 入口までの時間を測る。
+// SDK の GPIO ディスパッチと XIP キャッシュミスの影響を含む。
+#define CEC_RX_PROBE_INTERVAL_US 100000
+#define CEC_RX_PROBE_IDLE_US      10000
+
+static volatile bool     g_probe_pending = false;
+static volatile uint32_t g_probe_t0 = 0;
+static uint32_t          g_probe_last_us = 0;  // 直近のプローブ実施時刻
+static volatile uint32_t g_lat_last_us = 0;
+static volatile uint32_t g_lat_max_us = 0;
+static volatile uint32_t g_lat_count = 0;
+
+static inline io_irq_ctrl_hw_t *irq_ctrl(void) {
+    return get_core_num() ? &io_bank0_hw->proc1_irq_ctrl : &io_bank0_hw->proc0_irq_ctrl;
+}
 
-static inline bool should_ack_header(uint8_t header_byte) {
+static inline bool HOT_FUNC(should_ack_header)(const rx_bus_t *b, uint8_t header_byte) {
     uint8_t dst = header_byte & 0x0F;
-    return g_ack_enabled && (dst == (g_logical_addr & 0x0F));
+    return b->ack_enabled && (dst == (b->logical_addr & 0x0F));
 }
 
-static void cec_irq(uint gpio, uint32_t events) {
-    if (gpio != cec_od_gpio()) {
-        return;
+// 1 エッジ分の復号
+static void HOT_FUNC(rx_edge)(rx_bus_t *b, uint32_t now, uint32_t events) {
+    bool level = cec_od_read(b->id);
+
+    // レイテンシ計測プローブ (強制割り込み) — バスが HIGH のままなら実エッジではない
+    if (b->main && g_probe_pending) {
+        hw_clear_bits(&irq_ctrl()->intf[b->gpio / 8], GPIO_IRQ_EDGE_FALL << (4 * (b->gpio % 8)));
+        g_probe_pending = false;
+        uint32_t lat = now - g_probe_t0;
+        g_lat_last_us = lat;
+        if (lat > g_lat_max_us) {
+            g_lat_max_us = lat;
+        }
+        g_lat_count++;
+        if (level) {
+            return;
+        }
     }
 
-    uint64_t now = time_us_64();
-    bool level = cec_od_read();
-
     // 立ち上がりで直前LOW幅を確定
-    if ((events & GPIO_IRQ_EDGE_RISE) && (g_last_level == false)) {
+    if ((events & GPIO_IRQ_EDGE_RISE) && (b->last_level == false)) {
 
         // 自分の ACK 解放による立ち上がりエッジは読み飛ばす
-        if (g_skip_next_rise) {
-            g_skip_next_rise = false;
-            g_last_level = level;
-            g_last_edge_us = now;
+        if (b->skip_next_rise) {
+            b->skip_next_rise = false;
+            b->last_level = level;
+            b->last_edge_us = now;
             return;
         }
 
-        uint32_t low_us = (uint32_t)(now - g_last_edge_us);
-        sym_t sym = classify_low(low_us);
+        uint32_t low_us = (uint32_t)(now - b->last_edge_us);
+        sym_t sym = classify_low(low_us, b->win);
+
+        if (b->cap_buf && b->cap_len < b->cap_max) {
+            b->cap_buf[b->cap_len++] = (cec_rx_sym_t){ (uint16_t)(low_us > UINT16_MAX ? UINT16_MAX : low_us), 0 };
+        }
+
+        // ACK スロットはフォロワーの引き延ばしで bit1/bit0 窓の隙間に落ちることがある
+        if (sym == SYM_INVALID && b->in_frame && b->bitpos == 9
+            && low_us > b->win->bit1_max && low_us < b->win->bit0_min) {
+            sym = SYM_0;
+        }
+
+        // 較正用の記録 (自分の送信はループバック中の ACK 幅のみ)
+        b->high_valid = false;
+        if (b->main && b->in_frame && (sym == SYM_0 || sym == SYM_1)) {
+            if (b->loopback) {
+                // 宛先フォロワーの ACK (directed のみ)
+                uint8_t dst = (b->first_byte ? b->cur : b->header) & 0x0F;
+                if (b->bitpos == 9 && sym == SYM_0 && dst != CEC_ADDR_BROADCAST) {
+                    cec_cal_record_ack(dst, low_us);
+                }
+            } else if (b->bitpos < 9) {
+                if (b->src == CEC_CAL_NO_LA) {
+                    b->pend_low[b->bitpos & 3] = (uint16_t)low_us;
+                    if (sym == SYM_1) {
+                        b->pend_one |= (uint8_t)(1u << (b->bitpos & 3));
+                    }
+                } else {
+                    cec_cal_record_low(b->src, low_us, sym == SYM_1);
+                    b->high_valid = true;
+                }
+            }
+        }
+
+        if (sym == SYM_INVALID && b->main) {
+            cec_stats_rx_invalid();
+        }
 
         if (sym == SYM_START) {
-            s_in_frame = true;
-            s_len = 0;
-            s_cur = 0;
-            s_bitpos = 0;
-            s_eom = false;
-            s_first_byte = true;
-            s_addressed_to_us = false;
-            s_header = 0;
-            g_skip_next_rise = false;
-        } else if (s_in_frame && (sym == SYM_0 || sym == SYM_1)) {
-            if (s_bitpos < 8) {
-                s_cur <<= 1;
-                if (sym == SYM_1) s_cur |= 1;
-                s_bitpos++;
-            } else if (s_bitpos == 8) {
-                s_eom = (sym == SYM_1);
-                s_bitpos++;
+            // EOM まで届かなかった前のフレーム (NACK 後の打ち切り等)
+            if (b->in_frame && b->main) {
+                cec_stats_rx_incomplete(b->cur_last_us - b->cur_start_us);
+            }
+            b->cur_start_us = now - low_us;
+            b->cur_last_us = now;
+            b->in_frame = true;
+            b->len = 0;
+            b->cur = 0;
+            b->bitpos = 0;
+            b->eom = false;
+            b->first_byte = true;
+            b->addressed_to_us = false;
+            b->header = 0;
+            b->skip_next_rise = false;
+            b->src = CEC_CAL_NO_LA;
+            b->win = cec_cal_window(CEC_CAL_NO_LA);
+            b->pend_one = 0;
+        } else if (b->in_frame && (sym == SYM_0 || sym == SYM_1)) {
+            b->cur_last_us = now;
+            if (b->bitpos < 8) {
+                b->cur <<= 1;
+                if (sym == SYM_1) b->cur |= 1;
+                b->bitpos++;
+
+                // イニシエータ判明 → 保留分を記録し、以降はその判定窓を使う
+                if (b->first_byte && b->bitpos == 4 && b->main) {
+                    b->src = b->cur & 0x0F;
+                    b->win = cec_cal_window(b->src);
+                    if (!b->loopback) {
+                        for (int i = 0; i < 4; i++) {
+                            cec_cal_record_low(b->src, b->pend_low[i], (b->pend_one >> i) & 1u);
+                        }
+                    }
+                }
+            } else if (b->bitpos == 8) {
+                b->eom = (sym == SYM_1);
+                b->bitpos++;
             } else {
                 // ACKスロット
                 bool do_ack = false;
-                if (s_first_byte) {
-                    s_addressed_to_us = should_ack_header(s_cur);
-                    do_ack = s_addressed_to_us;
+                if (b->first_byte) {
+                    b->addressed_to_us = should_ack_header(b, b->cur);
+                    do_ack = b->addressed_to_us;
                 } else {
                     // 自分宛てフレームの2バイト目以降のみACK
-                    do_ack = g_ack_enabled && s_addressed_to_us;
+                    do_ack = b->ack_enabled && b->addressed_to_us;
                 }
 
-                if (do_ack) {
-                    ack_hold_start();
+                // 自分の送信中は自分宛て (ポーリング等) でも ACK しない
+                if (do_ack && !b->loopback) {
+                    b->ack_hold_us = cec_cal_ack_hold_us(b->src);
+                    ack_hold_start(b);
                 }
 
-                if (s_len < sizeof(s_buf)) {
-                    s_buf[s_len++] = s_cur;
+                if (b->len < sizeof(b->buf)) {
+                    b->buf[b->len++] = b->cur;
+                    if (b->loopback) {
+                        b->lb_bytes[b->len - 1] = b->cur;
+                        b->lb_len = b->len;
+                    }
                 }
 
-                if (s_first_byte) {
-                    s_header = s_cur;
-                    s_first_byte = false;
+                if (b->first_byte) {
+                    b->header = b->cur;
+                    b->first_byte = false;
                 }
 
-                s_cur = 0;
-                s_bitpos = 0;
+                b->cur = 0;
+                b->bitpos = 0;
 
-                if (s_eom) {
-                    if (!g_frame_ready) {
-                        g_frame_len = s_len;
-                        for (uint8_t i = 0; i < s_len; i++) {
-                            g_frame_bytes[i] = s_buf[i];
+                if (b->eom) {
+                    if (b->main) {
+                        cec_stats_rx_frame(b->buf, b->len, now - b->cur_start_us);
+                    }
+                    if (!b->loopback && !b->frame_ready) {
+                        b->frame_len = b->len;
+                        for (uint8_t i = 0; i < b->len; i++) {
+                            b->frame_bytes[i] = b->buf[i];
                         }
-                        g_frame_ready = true;
+                        b->frame_acked = b->addressed_to_us || (b->header & 0x0F) == CEC_ADDR_BROADCAST;
+                        b->frame_start_us = b->cur_start_us;
+                        b->frame_end_us = now;
+                        b->frame_ready = true;
                     }
-                    s_in_frame = false;
+                    b->in_frame = false;
                 }
             }
         } else {
             // invalid
         }
+    } else if ((events & GPIO_IRQ_EDGE_FALL) && b->last_level) {
+        // 立ち下がりで直前 HIGH 幅を確定
+        uint32_t high_us = now - b->last_edge_us;
+        if (b->high_valid) {
+            cec_cal_record_high(b->src, high_us);
+            b->high_valid = false;
+        }
+        if (b->cap_buf && b->cap_len > 0 && b->cap_buf[b->cap_len - 1].high_us == 0) {
+            b->cap_buf[b->cap_len - 1].high_us = (uint16_t)(high_us > UINT16_MAX ? UINT16_MAX : high_us);
+        }
     }
 
-    g_last_level = level;
-    g_last_edge_us = now;
+    b->last_level = level;
+    b->last_edge_us = now;
+}
+
+// GPIO 割り込みハンドラ (全バス共通)。GPIO 番号からバスを引いて復号し、処理時間をバスごとに積算する
+static void HOT_FUNC(cec_irq)(uint gpio, uint32_t events) {
+    uint32_t now = time_us_32();
+
+    for (uint i = 0; i < CEC_BUS_MAX; i++) {
+        rx_bus_t *b = &g_bus[i];
+        if (!b->used || b->gpio != gpio) {
+            continue;
+        }
+
+        rx_edge(b, now, events);
+
+        uint32_t isr_us = time_us_32() - now;
+        b->isr_count++;
+        b->isr_sum_us += isr_us;
+        if (isr_us > b->isr_max_us) {
+            b->isr_max_us = isr_us;
+        }
+        return;
+    }
 }
 
-void cec_rx_init(uint cec_gpio) {
-    // NOTE: cec_od_init() は cec_tx_init() で行う。先に呼ぶこと。
-    g_last_level = cec_od_read();
-    g_last_edge_us = time_us_64();
+void cec_rx_init(uint bus, uint cec_gpio) {
+    // NOTE: cec_od_init() を先に呼ぶこと (送信するバスは cec_tx_init() が行う)。
+    rx_bus_t *b = &g_bus[bus];
+    if (bus == CEC_BUS_MAIN) {
+        cec_cal_init();
+    }
+    b->id = (uint8_t)bus;
+    b->main = bus == CEC_BUS_MAIN;
+    b->gpio = cec_gpio;
+    b->logical_addr = 0x05;
+    b->ack_alarm = -1;
+    b->ack_hold_us = 700;
+    b->src = CEC_CAL_NO_LA;
+    b->win = cec_cal_window(CEC_CAL_NO_LA);
+    b->last_level = cec_od_read(bus);
+    b->last_edge_us = time_us_32();
+    b->since_us = time_us_64();
+    b->used = true;
 
     gpio_set_irq_enabled_with_callback(
         cec_gpio,
@@ -186,25 +372,131 @@ void cec_rx_init(uint cec_gpio) {
     );
 }
 
-void cec_rx_set_logical_addr(uint8_t logical_addr) {
-    g_logical_addr = (uint8_t)(logical_addr & 0x0F);
+void cec_rx_set_logical_addr(uint bus, uint8_t logical_addr) {
+    g_bus[bus].logical_addr = (uint8_t)(logical_addr & 0x0F);
 }
 
-void cec_rx_enable_ack(bool enable) {
-    g_ack_enabled = enable;
+void cec_rx_enable_ack(uint bus, bool enable) {
+    g_bus[bus].ack_enabled = enable;
+}
+
+void cec_rx_loopback_begin(uint bus) {
+    rx_bus_t *b = &g_bus[bus];
+    uint32_t save = save_and_disable_interrupts();
+    b->lb_len = 0;
+    b->skip_next_rise = false;
+    b->loopback = true;
+    restore_interrupts(save);
+}
+
+uint8_t cec_rx_loopback_end(uint bus, uint8_t *out, uint8_t max) {
+    rx_bus_t *b = &g_bus[bus];
+    uint32_t save = save_and_disable_interrupts();
+    b->loopback = false;
+    uint8_t n = b->lb_len < max ? b->lb_len : max;
+    if (out) {
+        memcpy(out, b->lb_bytes, n);
+    }
+    restore_interrupts(save);
+    return n;
+}
+
+void cec_rx_capture_start(uint bus, cec_rx_sym_t *buf, uint max) {
+    rx_bus_t *b = &g_bus[bus];
+    uint32_t save = save_and_disable_interrupts();
+    b->cap_len = 0;
+    b->cap_max = max;
+    b->cap_buf = buf;
+    restore_interrupts(save);
+}
+
+uint cec_rx_capture_stop(uint bus) {
+    rx_bus_t *b = &g_bus[bus];
+    uint32_t save = save_and_disable_interrupts();
+    b->cap_buf = NULL;
+    uint n = b->cap_len;
+    restore_interrupts(save);
+    return n;
+}
+
+uint32_t cec_rx_idle_us(uint bus) {
+    rx_bus_t *b = &g_bus[bus];
+    uint32_t save = save_and_disable_interrupts();
+    uint32_t last = b->last_edge_us;
+    bool level = b->last_level;
+    restore_interrupts(save);
+
+    if (!level || !cec_od_read(bus)) {
+        return 0;
+    }
+    return time_us_32() - last;
+}
+
+void cec_rx_latency_probe(void) {
+    uint32_t now = time_us_32();
+    if (now - g_probe_last_us < CEC_RX_PROBE_INTERVAL_US
+        || g_probe_pending || cec_rx_idle_us(CEC_BUS_MAIN) < CEC_RX_PROBE_IDLE_US) {
+        return;
+    }
+    g_probe_last_us = now;
+
+    uint gpio = g_bus[CEC_BUS_MAIN].gpio;
+    uint32_t save = save_and_disable_interrupts();
+    g_probe_pending = true;
+    hw_set_bits(&irq_ctrl()->intf[gpio / 8], GPIO_IRQ_EDGE_FALL << (4 * (gpio % 8)));
+    g_probe_t0 = time_us_32();
+    restore_interrupts(save);  // ここで割り込みが入る
+}
+
+void cec_rx_latency_sample(uint32_t *count, uint32_t *last_us) {
+    *count = g_lat_count;
+    *last_us = g_lat_last_us;
+}
+
+void cec_rx_dump_latency(void) {
+    printf("CEC RX ISR latency (hot path RAM: %s)\n", CEC_HOT_PATH_RAM ? "on" : "off");
+    printf("  edge->ISR last=%lu us max=%lu us (%lu probes)\n",
+           (unsigned long)g_lat_last_us, (unsigned long)g_lat_max_us, (unsigned long)g_lat_count);
+
+    // バスごとの CPU 負荷。full = バス使用率 100% (1 ビット 2 エッジ) で受信し続けたときの見積もり
+    uint64_t now = time_us_64();
+    for (uint i = 0; i < CEC_BUS_MAX; i++) {
+        const rx_bus_t *b = &g_bus[i];
+        if (!b->used) {
+            continue;
+        }
+        uint32_t save = save_and_disable_interrupts();
+        uint32_t count = b->isr_count;
+        uint64_t sum = b->isr_sum_us;
+        restore_interrupts(save);
+
+        uint64_t elapsed = now - b->since_us;
+        uint32_t avg_x10 = count ? (uint32_t)(sum * 10 / count) : 0;
+        uint32_t load_x1e4 = elapsed ? (uint32_t)(sum * 1000000 / elapsed) : 0;   // 0.0001% 単位
+        uint32_t full_x100 = avg_x10 * (2 * 1000000 / CEC_T_BIT_TOTAL) / 1000;    // 0.01% 単位
+        printf("  bus %u GPIO %u: %lu edges, ISR avg=%lu.%lu us max=%lu us, load=%lu.%04lu%% (full bus ~%lu.%02lu%%)\n",
+               i, b->gpio, (unsigned long)count,
+               (unsigned long)(avg_x10 / 10), (unsigned long)(avg_x10 % 10), (unsigned long)b->isr_max_us,
+               (unsigned long)(load_x1e4 / 10000), (unsigned long)(load_x1e4 % 10000),
+               (unsigned long)(full_x100 / 100), (unsigned long)(full_x100 % 100));
+    }
 }
 
-bool cec_rx_poll_frame(cec_frame_t* out) {
-    if (!g_frame_ready) {
+bool cec_rx_poll_frame(uint bus, cec_frame_t* out) {
+    rx_bus_t *b = &g_bus[bus];
+    if (!b->frame_ready) {
         return false;
     }
 
     uint32_t save = save_and_disable_interrupts();
     if (out) {
-        out->len = g_frame_len;
-        memcpy(out->bytes, (const void *)g_frame_bytes, g_frame_len);
+        out->len = b->frame_len;
+        memcpy(out->bytes, (const void *)b->frame_bytes, b->frame_len);
+        out->acked = b->frame_acked;
+        out->start_us = b->frame_start_us;
+        out->end_us = b->frame_end_us;
     }
-    g_frame_ready = false;
+    b->frame_ready = false;
     restore_interrupts(save);
     return true;
 }
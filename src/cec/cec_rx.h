@@ -2,17 +2,48 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "pico/stdlib.h"
+#include "cec_bus.h"
 
 #define CEC_MAX_FRAME_BYTES 16
 
 typedef struct {
-    uint8_t bytes[CEC_MAX_FRAME_BYTES];
-    uint8_t len;
+    uint8_t  bytes[CEC_MAX_FRAME_BYTES];
+    uint8_t  len;
+    bool     acked;      // 受理済み (自分宛てに ACK した / broadcast)
+    uint32_t start_us;   // スタートビットの立ち下がり (time_us_32)
+    uint32_t end_us;     // EOM バイトの ACK スロット終わり
 } cec_frame_t;
 
-void cec_rx_init(uint cec_gpio);
-void cec_rx_set_logical_addr(uint8_t logical_addr);
-void cec_rx_enable_ack(bool enable);
+// バスごとに初期化する (GPIO 割り込みハンドラは全バス共通)
+void cec_rx_init(uint bus, uint cec_gpio);
+void cec_rx_set_logical_addr(uint bus, uint8_t logical_addr);
+void cec_rx_enable_ack(uint bus, bool enable);
+
+// 自己送信ループバック (cec_tx_send_bytes から呼ぶ)
+// begin〜end の間は RX が自分の送信波形を復号し、ACK 応答とフレーム通知を行わない。
+// end は復号できたバイト列をコピーし、そのバイト数を返す。
+void cec_rx_loopback_begin(uint bus);
+uint8_t cec_rx_loopback_end(uint bus, uint8_t *out, uint8_t max);
+
+// 自己試験用シンボル記録: start〜stop の間、立ち上がりごとに LOW 幅、次の立ち下がりで HIGH 幅を記録
+// (最後のシンボルの HIGH はバスがアイドルに戻るので 0 のまま)。stop は記録できたシンボル数を返す
+typedef struct {
+    uint16_t low_us;
+    uint16_t high_us;
+} cec_rx_sym_t;
+
+void cec_rx_capture_start(uint bus, cec_rx_sym_t *buf, uint max);
+uint cec_rx_capture_stop(uint bus);
+
+// バスが HIGH のまま経過した時間 (µs)。LOW 中は 0
+uint32_t cec_rx_idle_us(uint bus);
+
+// ISR レイテンシ計測: メインループで毎周期呼ぶ (メインバスのアイドル時に 100 ms ごとにプローブ)
+void cec_rx_latency_probe(void);
+// レイテンシとバスごとの ISR 処理時間 / CPU 負荷を出力
+void cec_rx_dump_latency(void);
+// 計測回数と直近値 (クロックプロファイル別の集計用)
+void cec_rx_latency_sample(uint32_t *count, uint32_t *last_us);
 
 // フレームが1つ取れたら true
-bool cec_rx_poll_frame(cec_frame_t* out);
+bool cec_rx_poll_frame(uint bus, cec_frame_t* out);
@@ -0,0 +1,153 @@
+#include "cec_stats.h"
+#include "cec_opcode.h"
+#include "hot_path.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+
+#define CEC_LA_COUNT 16
+
+typedef struct {
+    uint32_t frames;
+    uint64_t busy_us;
+} initiator_t;
+
+typedef struct {
+    uint32_t tag;       // time_us_64() >> CEC_STATS_BUCKET_SHIFT
+    uint32_t busy_us;
+} bucket_t;
+
+// RX
+static initiator_t g_init[CEC_LA_COUNT];
+static uint32_t    g_opcode[256];
+static uint32_t    g_polls;
+static uint32_t    g_incomplete;
+static uint32_t    g_invalid;
+static uint64_t    g_busy_total_us;
+
+// TX
+static uint32_t g_tx_attempts;
+static uint32_t g_tx_retries;
+static uint32_t g_tx_nack_header;
+static uint32_t g_tx_nack_data;
+static uint32_t g_tx_collisions;
+static uint32_t g_tx_bus_busy;
+
+// 利用率
+static bucket_t g_bucket[CEC_STATS_BUCKETS];
+static uint32_t g_peak_busy_us;   // 窓から外れたバケットの最大値
+
+static void HOT_FUNC(add_busy)(uint32_t busy_us) {
+    uint32_t tag = (uint32_t)(time_us_64() >> CEC_STATS_BUCKET_SHIFT);
+    bucket_t *b = &g_bucket[tag % CEC_STATS_BUCKETS];
+    if (b->tag != tag) {
+        if (b->busy_us > g_peak_busy_us) {
+            g_peak_busy_us = b->busy_us;
+        }
+        b->tag = tag;
+        b->busy_us = 0;
+    }
+    b->busy_us += busy_us;
+    g_busy_total_us += busy_us;
+}
+
+void HOT_FUNC(cec_stats_rx_frame)(const uint8_t *bytes, uint8_t len, uint32_t busy_us) {
+    initiator_t *in = &g_init[bytes[0] >> 4];
+    in->frames++;
+    in->busy_us += busy_us;
+    if (len >= 2) {
+        g_opcode[bytes[1]]++;
+    } else {
+        g_polls++;
+    }
+    add_busy(busy_us);
+}
+
+void HOT_FUNC(cec_stats_rx_incomplete)(uint32_t busy_us) {
+    g_incomplete++;
+    add_busy(busy_us);
+}
+
+void HOT_FUNC(cec_stats_rx_invalid)(void) {
+    g_invalid++;
+}
+
+void cec_stats_tx_attempt(void)   { g_tx_attempts++; }
+void cec_stats_tx_retry(void)     { g_tx_retries++; }
+void cec_stats_tx_collision(void) { g_tx_collisions++; }
+void cec_stats_tx_bus_busy(void)  { g_tx_bus_busy++; }
+
+void cec_stats_tx_nack(bool header) {
+    if (header) {
+        g_tx_nack_header++;
+    } else {
+        g_tx_nack_data++;
+    }
+}
+
+// 直近の窓 (現在のバケットは経過分のみ) の占有時間と長さ
+static void window(uint64_t *busy_us, uint64_t *span_us, uint32_t *peak_us) {
+    uint64_t now = time_us_64();
+    uint32_t cur = (uint32_t)(now >> CEC_STATS_BUCKET_SHIFT);
+    uint64_t busy = 0;
+    uint32_t peak = g_peak_busy_us;
+    for (int i = 0; i < CEC_STATS_BUCKETS; i++) {
+        if (cur - g_bucket[i].tag < CEC_STATS_BUCKETS) {
+            busy += g_bucket[i].busy_us;
+            if (g_bucket[i].busy_us > peak) {
+                peak = g_bucket[i].busy_us;
+            }
+        }
+    }
+    uint32_t full = cur < CEC_STATS_BUCKETS - 1 ? cur : CEC_STATS_BUCKETS - 1;
+    *busy_us = busy;
+    *peak_us = peak;
+    *span_us = ((uint64_t)full << CEC_STATS_BUCKET_SHIFT) + (now & ((1u << CEC_STATS_BUCKET_SHIFT) - 1));
+}
+
+uint32_t cec_stats_utilisation_permille(void) {
+    uint64_t busy, span;
+    uint32_t peak;
+    window(&busy, &span, &peak);
+    return span ? (uint32_t)(busy * 1000 / span) : 0;
+}
+
+static void print_permille(uint32_t pm) {
+    printf("%lu.%lu%%", (unsigned long)(pm / 10), (unsigned long)(pm % 10));
+}
+
+void cec_stats_dump(void) {
+    uint64_t now = time_us_64();
+    uint64_t busy, span;
+    uint32_t peak;
+    window(&busy, &span, &peak);
+
+    printf("CEC bus stats (uptime %lu s)\n", (unsigned long)(now / 1000000));
+    printf("  utilisation: last %lu ms ", (unsigned long)(span / 1000));
+    print_permille(span ? (uint32_t)(busy * 1000 / span) : 0);
+    printf(", peak ~1 s ");
+    print_permille((uint32_t)((uint64_t)peak * 1000 >> CEC_STATS_BUCKET_SHIFT));
+    printf(", since boot ");
+    print_permille(now ? (uint32_t)(g_busy_total_us * 1000 / now) : 0);
+    printf("\n");
+    printf("  RX: polls=%lu incomplete=%lu invalid symbols=%lu\n",
+           (unsigned long)g_polls, (unsigned long)g_incomplete, (unsigned long)g_invalid);
+    printf("  TX: attempts=%lu retries=%lu nack header=%lu data=%lu collisions=%lu bus busy=%lu\n",
+           (unsigned long)g_tx_attempts, (unsigned long)g_tx_retries, (unsigned long)g_tx_nack_header,
+           (unsigned long)g_tx_nack_data, (unsigned long)g_tx_collisions, (unsigned long)g_tx_bus_busy);
+
+    for (int la = 0; la < CEC_LA_COUNT; la++) {
+        const initiator_t *in = &g_init[la];
+        if (in->frames == 0) {
+            continue;
+        }
+        printf("  LA %2d: frames=%lu busy=%lu ms (", la, (unsigned long)in->frames,
+               (unsigned long)(in->busy_us / 1000));
+        print_permille(g_busy_total_us ? (uint32_t)(in->busy_us * 1000 / g_busy_total_us) : 0);
+        printf(" of bus time)\n");
+    }
+    for (int op = 0; op < 256; op++) {
+        if (g_opcode[op]) {
+            printf("  0x%02X %-28s %lu\n", op, cec_opcode_name((uint8_t)op), (unsigned long)g_opcode[op]);
+        }
+    }
+}
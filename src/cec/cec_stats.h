@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+// CEC バス負荷・トラフィック統計
+// RX ISR と送信処理から O(1) で固定サイズのカウンタを更新する。
+// バス占有時間はスタートビットの立ち下がりからフレーム最後のシンボルまで (自分の送信も含む)。
+// 利用率は約 1 秒 (2^20 µs) のバケットをリングで持ち、直近の窓で求める。
+
+#define CEC_STATS_BUCKET_SHIFT 20   // バケット長 = 2^20 µs ≒ 1.05 s
+#define CEC_STATS_BUCKETS      10   // 直近 ≒ 10 秒の利用率
+
+// ---- RX ISR から ----
+
+// 完結したフレーム (EOM まで受信)。busy_us = フレームのバス占有時間
+void cec_stats_rx_frame(const uint8_t *bytes, uint8_t len, uint32_t busy_us);
+// EOM 前に途切れたフレーム (NACK 後の打ち切り、衝突、ノイズ)
+void cec_stats_rx_incomplete(uint32_t busy_us);
+// どの判定窓にも入らない LOW 幅
+void cec_stats_rx_invalid(void);
+
+// ---- 送信処理から ----
+
+void cec_stats_tx_attempt(void);
+void cec_stats_tx_retry(void);
+void cec_stats_tx_nack(bool header);  // header = ヘッダブロックで NACK (宛先不在)
+void cec_stats_tx_collision(void);    // ループバック不一致 (アービトレーション負け / ビットエラー)
+void cec_stats_tx_bus_busy(void);     // 送信開始時にバスが LOW だった
+
+// 直近の窓のバス利用率 (0.1 % 単位)
+uint32_t cec_stats_utilisation_permille(void);
+
+// 統計を出力 (利用率 / イニシエータ別 / opcode 別 / TX エラー)
+void cec_stats_dump(void);
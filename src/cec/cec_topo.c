@@ -0,0 +1,171 @@
+#include "cec_topo.h"
+#include "cec_opcode.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#define CEC_LA_COUNT 16
+#define CEC_LA_TV    0x00
+
+static cec_topo_dev_t g_dev[CEC_LA_COUNT];
+static uint8_t  g_self_la = CEC_ADDR_AUDIO_SYSTEM;
+static uint8_t  g_active_la = CEC_TOPO_NO_LA;
+static uint16_t g_active_phys = 0xFFFF;
+
+static uint8_t find_la_by_phys(uint16_t phys) {
+    for (uint8_t la = 0; la < CEC_LA_COUNT; la++) {
+        if ((g_dev[la].flags & CEC_TOPO_HAS_PHYS_ADDR) && g_dev[la].phys_addr == phys) {
+            return la;
+        }
+    }
+    return CEC_TOPO_NO_LA;
+}
+
+void cec_topo_init(uint8_t self_la) {
+    memset(g_dev, 0, sizeof g_dev);
+    for (int i = 0; i < CEC_LA_COUNT; i++) {
+        g_dev[i].power = CEC_POWER_UNKNOWN;
+    }
+    g_self_la = self_la & 0x0F;
+    g_active_la = CEC_TOPO_NO_LA;
+    g_active_phys = 0xFFFF;
+}
+
+void cec_topo_observe(const cec_frame_t *f) {
+    if (f->len < 1) {
+        return;
+    }
+
+    uint8_t src = (f->bytes[0] >> 4) & 0x0F;
+    if (src == g_self_la) {
+        return;
+    }
+
+    cec_topo_dev_t *d = &g_dev[src];
+    d->last_seen_ms = to_ms_since_boot(get_absolute_time());
+    if (d->last_seen_ms == 0) {
+        d->last_seen_ms = 1;
+    }
+
+    if (f->len < 2) {
+        return;  // ポーリング
+    }
+
+    const uint8_t *op = &f->bytes[2];
+    uint8_t n = (uint8_t)(f->len - 2);  // オペランド長
+
+    switch (f->bytes[1]) {
+    case CEC_OP_REPORT_PHYSICAL_ADDRESS:
+        if (n >= 3) {
+            d->phys_addr = (uint16_t)((op[0] << 8) | op[1]);
+            d->device_type = op[2];
+            d->flags |= CEC_TOPO_HAS_PHYS_ADDR;
+        }
+        break;
+
+    case CEC_OP_ACTIVE_SOURCE:
+        if (n >= 2) {
+            g_active_la = src;
+            g_active_phys = (uint16_t)((op[0] << 8) | op[1]);
+            d->power = CEC_POWER_ON;
+        }
+        break;
+
+    case CEC_OP_SET_STREAM_PATH:
+        // TV がパスを切り替えた — 物理アドレスから論理アドレスを引く
+        if (src == CEC_LA_TV) {
+            d->power = CEC_POWER_ON;
+        }
+        if (n >= 2) {
+            g_active_phys = (uint16_t)((op[0] << 8) | op[1]);
+            g_active_la = find_la_by_phys(g_active_phys);
+        }
+        break;
+
+    case CEC_OP_SET_OSD_NAME: {
+        uint8_t len = n < CEC_TOPO_OSD_NAME_MAX ? n : CEC_TOPO_OSD_NAME_MAX;
+        memcpy(d->osd_name, op, len);
+        d->osd_name[len] = '\0';
+        d->flags |= CEC_TOPO_HAS_OSD_NAME;
+        break;
+    }
+
+    case CEC_OP_DEVICE_VENDOR_ID:
+        if (n >= 3) {
+            d->vendor_id = ((uint32_t)op[0] << 16) | ((uint32_t)op[1] << 8) | op[2];
+            d->flags |= CEC_TOPO_HAS_VENDOR_ID;
+        }
+        break;
+
+    case CEC_OP_REPORT_POWER_STATUS:
+        if (n >= 1) {
+            d->power = op[0];
+        }
+        break;
+
+    case CEC_OP_STANDBY:
+        // TV が Standby をブロードキャストするのは自身がスタンバイに入るとき
+        if (src == CEC_LA_TV && (f->bytes[0] & 0x0F) == CEC_ADDR_BROADCAST) {
+            d->power = CEC_POWER_STANDBY;
+            g_active_la = CEC_TOPO_NO_LA;
+            g_active_phys = 0xFFFF;
+        }
+        break;
+
+    default:
+        // 何か送ってきた = 起動している (スタンバイから復帰した TV は Report Power Status を送らないことが多い)
+        if (src == CEC_LA_TV) {
+            d->power = CEC_POWER_ON;
+        }
+        break;
+    }
+}
+
+const cec_topo_dev_t *cec_topo_get(uint8_t la) {
+    if (la >= CEC_LA_COUNT || g_dev[la].last_seen_ms == 0) {
+        return NULL;
+    }
+    return &g_dev[la];
+}
+
+uint8_t cec_topo_tv_power(void) {
+    return g_dev[CEC_LA_TV].power;
+}
+
+void cec_topo_dump(void) {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+
+    printf("CEC topology (active source: ");
+    if (g_active_la != CEC_TOPO_NO_LA) {
+        printf("LA %u", g_active_la);
+    } else {
+        printf("?");
+    }
+    if (g_active_phys != 0xFFFF) {
+        printf(" %X.%X.%X.%X", (g_active_phys >> 12) & 0xF, (g_active_phys >> 8) & 0xF,
+               (g_active_phys >> 4) & 0xF, g_active_phys & 0xF);
+    }
+    printf(")\n");
+
+    for (uint8_t la = 0; la < CEC_LA_COUNT; la++) {
+        const cec_topo_dev_t *d = &g_dev[la];
+        if (d->last_seen_ms == 0) {
+            continue;
+        }
+        printf("  LA %2u: seen %lu ms ago", la, (unsigned long)(now - d->last_seen_ms));
+        if (d->flags & CEC_TOPO_HAS_PHYS_ADDR) {
+            printf("  phys=%X.%X.%X.%X type=%u", (d->phys_addr >> 12) & 0xF, (d->phys_addr >> 8) & 0xF,
+                   (d->phys_addr >> 4) & 0xF, d->phys_addr & 0xF, d->device_type);
+        }
+        if (d->flags & CEC_TOPO_HAS_VENDOR_ID) {
+            printf("  vendor=%06lX", (unsigned long)d->vendor_id);
+        }
+        if (d->power != CEC_POWER_UNKNOWN) {
+            printf("  power=%u", d->power);
+        }
+        if (d->flags & CEC_TOPO_HAS_OSD_NAME) {
+            printf("  name=\"%s\"", d->osd_name);
+        }
+        printf("\n");
+    }
+}
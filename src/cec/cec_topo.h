@@ -0,0 +1,48 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "cec_rx.h"
+
+// CEC トポロジキャッシュ
+// バス上のトラフィックから論理アドレスごとの情報を受動的に収集する。
+// TV の電源状態をバスに問い合わせずに参照できる (アクティブソースはデバッグ出力のみ)。
+
+// Report Power Status の値
+#define CEC_POWER_ON              0x00
+#define CEC_POWER_STANDBY         0x01
+#define CEC_POWER_TO_ON           0x02
+#define CEC_POWER_TO_STANDBY      0x03
+#define CEC_POWER_UNKNOWN         0xFF
+
+#define CEC_TOPO_NO_LA            0xFF
+#define CEC_TOPO_OSD_NAME_MAX     14
+
+// cec_topo_dev_t.flags
+#define CEC_TOPO_HAS_PHYS_ADDR    0x01
+#define CEC_TOPO_HAS_VENDOR_ID    0x02
+#define CEC_TOPO_HAS_OSD_NAME     0x04
+
+typedef struct {
+    uint32_t last_seen_ms;   // 最終観測時刻 (ms since boot)。0 = 未観測
+    uint32_t vendor_id;      // 24 bit
+    uint16_t phys_addr;
+    uint8_t  device_type;
+    uint8_t  power;          // CEC_POWER_*
+    uint8_t  flags;          // CEC_TOPO_HAS_*
+    char     osd_name[CEC_TOPO_OSD_NAME_MAX + 1];
+} cec_topo_dev_t;
+
+// 自分の論理アドレスを指定して初期化 (自分の送信は記録しない)
+void cec_topo_init(uint8_t self_la);
+
+// 受信フレームを1つ取り込む
+void cec_topo_observe(const cec_frame_t *f);
+
+// 論理アドレスの情報 (未観測なら NULL)
+const cec_topo_dev_t *cec_topo_get(uint8_t la);
+
+// TV (LA 0) の電源状態 (CEC_POWER_*)
+uint8_t cec_topo_tv_power(void);
+
+// デバッグ出力
+void cec_topo_dump(void);
@@ -1,157 +1,250 @@
 #include "cec_tx.h"
 #include "cec_tx.pio.h"
+#include "cec_tx_cache.h"
 #include "cec_rx.h"
 #include "cec_od.h"
 #include "cec_timing.h"
+#include "cec_cal.h"
+#include "cec_stats.h"
+#include "hot_path.h"
+#include "diag/stall.h"
+#include "log.h"
 #include <stdio.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/pio.h"
 #include "hardware/gpio.h"
 #include "hardware/clocks.h"
 
-#define CEC_TX_IDLE_US          5000 // バス送信前のアイドル確認時間
-#define CEC_ACK_SAMPLE_DELAY_US 1050 // FIFO drain から ACK サンプルまで (µs)
-
-static PIO  g_pio;
-static uint g_sm;
-static uint g_prog_offset;
-static uint g_cec_gpio;
+// 呼び出し (バス空き確認の直後) から Start ビット投入までの時間
+typedef struct {
+    uint32_t count;
+    uint32_t sum_us;
+    uint32_t max_us;
+} start_stats_t;
+
+// バスごとの送信コンテキスト
+typedef struct {
+    PIO      pio;                  // NULL = 未初期化
+    uint     sm;
+    uint     prog_offset;
+    uint     gpio;
+    uint32_t frames;               // 送信を開始したフレーム数
+    uint64_t busy_us;              // 送信で CPU を占有した時間 (Start ビット〜ループバック照合)
+} tx_bus_t;
+
+static tx_bus_t g_tx[CEC_BUS_MAX];
+
+static start_stats_t g_start_stats;
+
+// 他のバスが載せたプログラムを同じ PIO の空き SM で共有する (命令メモリは 1 本分で済む)
+static bool cec_tx_share_program(tx_bus_t *t) {
+    for (int i = 0; i < CEC_BUS_MAX; i++) {
+        const tx_bus_t *o = &g_tx[i];
+        if (!o->pio || t->gpio < pio_get_gpio_base(o->pio) || t->gpio >= pio_get_gpio_base(o->pio) + 32) {
+            continue;
+        }
+        int sm = pio_claim_unused_sm(o->pio, false);
+        if (sm >= 0) {
+            t->pio = o->pio;
+            t->sm = (uint)sm;
+            t->prog_offset = o->prog_offset;
+            return true;
+        }
+    }
+    return false;
+}
 
-void cec_tx_init(uint gpio) {
-    g_cec_gpio = gpio;
-    cec_od_init(gpio);
+void cec_tx_init(uint bus, uint gpio) {
+    tx_bus_t *t = &g_tx[bus];
+    t->gpio = gpio;
+    cec_od_init(bus, gpio);
 
     // PIO / SM / プログラムを確保
-    if (!pio_claim_free_sm_and_add_program_for_gpio_range(
-            &cec_tx_program, &g_pio, &g_sm, &g_prog_offset,
+    if (!cec_tx_share_program(t)
+        && !pio_claim_free_sm_and_add_program_for_gpio_range(
+            &cec_tx_program, &t->pio, &t->sm, &t->prog_offset,
             gpio, 1, true)) {
         panic("CEC TX: no free PIO SM");
     }
 
     // SM 構成 (GPIO は SIO に戻して返す)
-    cec_tx_program_init(g_pio, g_sm, g_prog_offset, gpio);
+    cec_tx_program_init(t->pio, t->sm, t->prog_offset, gpio);
 }
 
-static void cec_wait_idle(uint32_t idle_us) {
+void cec_tx_clock_changed(void) {
+    // 送信は同期処理なので呼び出し時点で全バスの SM は停止している
+    for (int i = 0; i < CEC_BUS_MAX; i++) {
+        if (g_tx[i].pio) {
+            pio_sm_set_clkdiv(g_tx[i].pio, g_tx[i].sm, cec_tx_clkdiv());
+        }
+    }
+}
+
+static void cec_wait_idle(uint bus, uint32_t idle_us) {
     absolute_time_t t0 = get_absolute_time();
     while (absolute_time_diff_us(t0, get_absolute_time()) < (int64_t)idle_us) {
-        if (!cec_od_read()) {
+        if (!cec_od_read(bus)) {
             t0 = get_absolute_time();
         }
         tight_loop_contents();
     }
 }
 
-// シンボル1個分 (LOW→HIGH) を FIFO に投入
-// X_low = low_us - 3, X_high = high_us - 4 (PIO 命令オーバーヘッド補正)
-static inline void cec_tx_push_symbol(uint32_t low_us, uint32_t high_us) {
-    uint32_t word = ((low_us - 3u) << 16) | (high_us - 4u);
-    pio_sm_put_blocking(g_pio, g_sm, word);
-}
+#define CEC_TX_WORD_START CEC_TX_WORD(CEC_T_START_LOW, CEC_T_START_HIGH)
 
-bool cec_tx_send_bytes(const uint8_t *bytes, size_t len) {
-    if (!bytes || len == 0 || len > CEC_MAX_FRAME_BYTES) {
-        return false;
+cec_tx_result_t HOT_FUNC(cec_tx_send_bytes)(uint bus, const uint8_t *bytes, size_t len, const uint32_t *words) {
+    tx_bus_t *t = &g_tx[bus];
+    if (!bytes || !words || len == 0 || len > CEC_MAX_FRAME_BYTES) {
+        return CEC_TX_NOT_SENT;
+    }
+    uint32_t t0 = time_us_32();
+
+    if (bus == CEC_BUS_MAIN) {
+        cec_stats_tx_attempt();
     }
 
     // バス HIGH 確認 — LOW なら他者が送信中
-    if (!cec_od_read()) {
-        return false;
+    if (!cec_od_read(bus)) {
+        if (bus == CEC_BUS_MAIN) {
+            cec_stats_tx_bus_busy();
+        }
+        return CEC_TX_NOT_SENT;
     }
 
     // dst=0xF → broadcast (HIGH=success), else directed (LOW=success)
     bool broadcast = (bytes[0] & 0x0F) == 0x0F;
+    uint32_t ack_sample_us = cec_cal_ack_sample_us(broadcast ? CEC_CAL_NO_LA : (bytes[0] & 0x0F));
 
     // ---- TX 開始 ----
 
-    // RX GPIO IRQ を無効化 (PIO 波形でエッジ割込が誤発火するのを防ぐ)
-    gpio_set_irq_enabled(g_cec_gpio, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, false);
+    // RX は止めずにループバック復号させる (送信直後の他者フレームも取りこぼさない)
+    cec_rx_loopback_begin(bus);
 
     // GPIO を PIO に切り替え
-    gpio_set_function(g_cec_gpio, PIO_FUNCSEL_NUM(g_pio, g_cec_gpio));
+    gpio_set_function(t->gpio, PIO_FUNCSEL_NUM(t->pio, t->gpio));
 
     // SM リセット + 有効化
-    pio_sm_clear_fifos(g_pio, g_sm);
-    pio_sm_restart(g_pio, g_sm);
-    pio_sm_exec(g_pio, g_sm, pio_encode_jmp(g_prog_offset));
-    pio_sm_set_enabled(g_pio, g_sm, true);
+    pio_sm_clear_fifos(t->pio, t->sm);
+    pio_sm_restart(t->pio, t->sm);
+    pio_sm_exec(t->pio, t->sm, pio_encode_jmp(t->prog_offset));
+    pio_sm_set_enabled(t->pio, t->sm, true);
 
     // Start ビット
-    cec_tx_push_symbol(CEC_T_START_LOW, CEC_T_START_HIGH);
+    pio_sm_put_blocking(t->pio, t->sm, CEC_TX_WORD_START);
+    uint32_t t_start = time_us_32();
+
+    start_stats_t *ss = &g_start_stats;
+    uint32_t start_us = t_start - t0;
+    ss->count++;
+    ss->sum_us += start_us;
+    if (start_us > ss->max_us) {
+        ss->max_us = start_us;
+    }
 
-    bool success = true;
+    cec_tx_result_t result = CEC_TX_OK;
+    size_t sent = 0;  // ACK スロットまで送り終えたバイト数
 
-    // データバイト: 8ビット(MSB first) + EOM + ACK (バイトごとに ACK 検出)
+    // データバイト: 符号化済みの 8ビット + EOM + ACK を流し込む (バイトごとに ACK 検出)
     for (size_t i = 0; i < len; i++) {
-        bool eom = (i == len - 1);
-        uint8_t b = bytes[i];
-
-        // 8 データビット (MSB first)
-        for (int bit = 7; bit >= 0; bit--) {
-            if ((b >> bit) & 1u) {
-                cec_tx_push_symbol(CEC_T_BIT1_LOW, CEC_T_BIT1_HIGH);
-            } else {
-                cec_tx_push_symbol(CEC_T_BIT0_LOW, CEC_T_BIT0_HIGH);
-            }
+        const uint32_t *w = &words[i * CEC_TX_WORDS_PER_BYTE];
+        for (int k = 0; k < CEC_TX_WORDS_PER_BYTE; k++) {
+            pio_sm_put_blocking(t->pio, t->sm, w[k]);
         }
 
-        // EOM ビット
-        if (eom) {
-            cec_tx_push_symbol(CEC_T_BIT1_LOW, CEC_T_BIT1_HIGH);
-        } else {
-            cec_tx_push_symbol(CEC_T_BIT0_LOW, CEC_T_BIT0_HIGH);
-        }
-
-        // ACK スロット: 送信側は "1" (解放) を送る
-        cec_tx_push_symbol(CEC_T_BIT1_LOW, CEC_T_BIT1_HIGH);
-
         // ---- ACK サンプリング ----
 
         // FIFO empty 待ち (PIO が ACK ワードを pull した直後)
-        while (!pio_sm_is_tx_fifo_empty(g_pio, g_sm)) {
+        while (!pio_sm_is_tx_fifo_empty(t->pio, t->sm)) {
             tight_loop_contents();
         }
 
-        // ACK サンプルポイントまで待機
-        sleep_us(CEC_ACK_SAMPLE_DELAY_US);
+        // ACK サンプルポイントまで待機 (宛先フォロワーの ACK 幅から較正、既定 1050 µs)
+        sleep_us(ack_sample_us);
 
         // バス状態サンプリング (PIO が GPIO を所有中でも gpio_get は動作する)
-        bool bus_low = !gpio_get(g_cec_gpio);
+        bool bus_low = !gpio_get(t->gpio);
 
         // ACK 判定: directed は LOW=ACK, broadcast は HIGH=ACK (極性が逆)
         bool ack_ok = broadcast ? !bus_low : bus_low;
 
         // PIO が ACK シンボル完了して pull block で停止するまで待機
-        while (pio_sm_get_pc(g_pio, g_sm) != g_prog_offset) {
+        stall_enter(STALL_SITE_CEC_TX_WAIT);
+        while (pio_sm_get_pc(t->pio, t->sm) != t->prog_offset) {
             tight_loop_contents();
         }
+        stall_leave();
+        sent++;
 
         if (!ack_ok) {
-            printf("  CEC TX NACK byte %u\n", (unsigned)i);
-            success = false;
+            LOG_D("  CEC TX NACK byte %u\n", (unsigned)i);
+            if (bus == CEC_BUS_MAIN) {
+                cec_stats_tx_nack(i == 0);
+            }
+            result = CEC_TX_NACK;
             break;
         }
     }
 
     // ---- TX 終了 ----
 
-    pio_sm_set_enabled(g_pio, g_sm, false);
+    pio_sm_set_enabled(t->pio, t->sm, false);
 
     // GPIO を SIO に戻す
-    gpio_set_function(g_cec_gpio, GPIO_FUNC_SIO);
+    gpio_set_function(t->gpio, GPIO_FUNC_SIO);
+
+    // ループバック検証: RX が復号した自分の波形と送信バイトを照合
+    // 不一致 = ビットエラー / アービトレーション負け → 送れなかった扱い (ACK の有無も当てにならない)
+    uint8_t lb[CEC_MAX_FRAME_BYTES];
+    uint8_t lb_len = cec_rx_loopback_end(bus, lb, sizeof lb);
+    if (lb_len < sent || memcmp(lb, bytes, sent) != 0) {
+        LOG_W("  CEC TX loopback mismatch (%u/%u bytes)\n", (unsigned)lb_len, (unsigned)sent);
+        if (bus == CEC_BUS_MAIN) {
+            cec_stats_tx_collision();
+        }
+        result = CEC_TX_NOT_SENT;
+    }
 
-    // RX GPIO IRQ を再有効化
-    gpio_set_irq_enabled(g_cec_gpio, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true);
+    t->frames++;
+    t->busy_us += time_us_32() - t_start;
 
-    return success;
+    return result;
 }
 
-bool cec_tx_send(const uint8_t *bytes, size_t len) {
-    for (int attempt = 0; attempt <= CEC_TX_MAX_RETRIES; attempt++) {
-        cec_wait_idle(CEC_TX_IDLE_US);
-        if (cec_tx_send_bytes(bytes, len)) {
-            return true;
+bool cec_tx_send(uint bus, const uint8_t *bytes, size_t len) {
+    // アイドル待ちの前にワード列を用意する
+    cec_tx_cache_kind_t kind;
+    int slot = bytes && len > 0 && len <= CEC_MAX_FRAME_BYTES ? cec_tx_cache_acquire(bytes, len, &kind) : -1;
+    if (slot < 0) {
+        return false;
+    }
+
+    bool ok = false;
+    stall_enter(STALL_SITE_CEC_TX);
+    for (int attempt = 0; attempt <= CEC_TX_MAX_RETRIES && !ok; attempt++) {
+        if (attempt > 0 && bus == CEC_BUS_MAIN) {
+            cec_stats_tx_retry();
+        }
+        cec_wait_idle(bus, CEC_TX_IDLE_US);
+        ok = cec_tx_send_bytes(bus, bytes, len, cec_tx_cache_words(slot)) == CEC_TX_OK;
+    }
+    stall_leave();
+    cec_tx_cache_release(slot);
+    return ok;
+}
+
+void cec_tx_dump_cache(void) {
+    cec_tx_cache_dump();
+    const start_stats_t *ss = &g_start_stats;
+    printf("  start bit %lu frames  avg=%lu us max=%lu us (bus check to start bit)\n", (unsigned long)ss->count,
+           (unsigned long)(ss->count ? ss->sum_us / ss->count : 0), (unsigned long)ss->max_us);
+
+    // 送信は完了までブロックするので、この時間はメインループ (他バスのフレーム処理) も止まる
+    for (int i = 0; i < CEC_BUS_MAX; i++) {
+        const tx_bus_t *t = &g_tx[i];
+        if (t->pio) {
+            printf("  bus %d GPIO %u: %lu frames, CPU blocked %lu ms (PIO%u SM%u)\n", i, t->gpio,
+                   (unsigned long)t->frames, (unsigned long)(t->busy_us / 1000), pio_get_index(t->pio), t->sm);
         }
     }
-    return false;
 }
@@ -3,15 +3,35 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "pico/types.h"
+#include "cec_bus.h"
 
 // NACK 時の最大リトライ回数 (CEC 仕様: 最大5回)
 #define CEC_TX_MAX_RETRIES 5
 
-// GPIO 初期化 (cec_od_init を内包)。cec_rx_init より先に呼ぶこと。
-void cec_tx_init(uint gpio);
+#define CEC_TX_IDLE_US 5000 // バス送信前のアイドル確認時間
+
+// 1 回の送信結果
+typedef enum {
+    CEC_TX_OK = 0,     // directed: ACK あり / broadcast: 拒否 (NACK) なし
+    CEC_TX_NACK,       // 最後まで送ったが directed で ACK なし / broadcast で拒否された
+    CEC_TX_NOT_SENT,   // バス使用中で送れなかった / ループバック不一致 (衝突・アービトレーション負け)
+} cec_tx_result_t;
+
+// バスごとの GPIO 初期化 (cec_od_init を内包) と PIO SM 確保。cec_rx_init より先に呼ぶこと。
+// SM はバスごとに 1 つ。プログラムは同じ PIO に空き SM があれば共有する。
+// 受信のみのバスは呼ばず、cec_od_init だけ行う。
+void cec_tx_init(uint bus, uint gpio);
+
+// clk_sys 変更後に全バスの PIO 分周比を再計算
+void cec_tx_clock_changed(void);
 
 // バスアイドル待ち + 送信 (NACK 時は自動リトライ)
-bool cec_tx_send(const uint8_t *bytes, size_t len);
+bool cec_tx_send(uint bus, const uint8_t *bytes, size_t len);
+
+// 送信のみ (アイドル待ちなし、リトライなし)。NACK と送れなかった場合を区別して返す。
+// words は cec_tx_cache_acquire() で前もって用意した bytes の PIO ワード列
+cec_tx_result_t cec_tx_send_bytes(uint bus, const uint8_t *bytes, size_t len, const uint32_t *words);
 
-// 送信のみ (アイドル待ちなし、リトライなし)
-bool cec_tx_send_bytes(const uint8_t *bytes, size_t len);
+// 符号化済みフレームキャッシュの統計、送信呼び出しから Start ビットまでの時間、
+// バスごとの送信フレーム数 / CPU 占有時間を出力
+void cec_tx_dump_cache(void);
@@ -0,0 +1,124 @@
+#include "cec_tx_cache.h"
+#include <stdio.h>
+#include <string.h>
+#include "cec_timing.h"
+#include "pico/stdlib.h"
+
+typedef struct {
+    uint8_t  len;                  // 0 = 空き
+    uint8_t  refs;                 // 確保中の送信数 (0 のときだけ書き換えてよい)
+    uint8_t  bytes[CEC_MAX_FRAME_BYTES];
+    uint32_t used;                 // 最終使用の通番 (LRU)
+    uint32_t words[CEC_MAX_FRAME_BYTES * CEC_TX_WORDS_PER_BYTE];
+} cec_tx_cached_t;
+
+// 種別ごとの回数と準備時間
+typedef struct {
+    uint32_t count;
+    uint32_t sum_us;
+    uint32_t max_us;
+} cache_stats_t;
+
+#define CEC_TX_WORD_1 CEC_TX_WORD(CEC_T_BIT1_LOW, CEC_T_BIT1_HIGH)
+#define CEC_TX_WORD_0 CEC_TX_WORD(CEC_T_BIT0_LOW, CEC_T_BIT0_HIGH)
+
+static cec_tx_cached_t g_cache[CEC_TX_CACHE_SLOTS];
+static uint32_t        g_cache_seq;
+static cache_stats_t   g_stats[CEC_TX_CACHE_KIND_COUNT];
+static uint32_t        g_full;     // 全スロット確保中で用意できなかった回数
+
+// データ 8 ビット (MSB first) を符号化
+static void cec_tx_encode_byte(uint32_t *w, uint8_t b) {
+    for (int bit = 7; bit >= 0; bit--) {
+        *w++ = ((b >> bit) & 1u) ? CEC_TX_WORD_1 : CEC_TX_WORD_0;
+    }
+}
+
+// フレーム全体を符号化: バイトごとに データ 8 + EOM + ACK スロット (送信側は "1" = 解放)
+static void cec_tx_encode(cec_tx_cached_t *e, const uint8_t *bytes, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        uint32_t *w = &e->words[i * CEC_TX_WORDS_PER_BYTE];
+        cec_tx_encode_byte(w, bytes[i]);
+        w[8] = (i == len - 1) ? CEC_TX_WORD_1 : CEC_TX_WORD_0;
+        w[9] = CEC_TX_WORD_1;
+    }
+    memcpy(e->bytes, bytes, len);
+    e->len = (uint8_t)len;
+}
+
+// 一致 (確保中でも共有) / 差分書き換え / LRU スロットに符号化 (どちらも確保中のスロットは使わない)
+int cec_tx_cache_acquire(const uint8_t *bytes, size_t len, cec_tx_cache_kind_t *kind) {
+    uint32_t t0 = time_us_32();
+    cec_tx_cached_t *best = NULL;
+    cec_tx_cached_t *victim = NULL;
+    uint best_diff = CEC_TX_PATCH_MAX + 1u;
+
+    for (int s = 0; s < CEC_TX_CACHE_SLOTS; s++) {
+        cec_tx_cached_t *e = &g_cache[s];
+        if (e->len == len) {
+            uint diff = 0;
+            for (size_t i = 0; i < len && diff < best_diff; i++) {
+                diff += e->bytes[i] != bytes[i];
+            }
+            if (diff < best_diff && (diff == 0 || e->refs == 0)) {
+                best = e;
+                best_diff = diff;
+            }
+        }
+        if (e->refs == 0
+            && (!victim || e->len == 0 || (victim->len != 0 && e->used < victim->used))) {
+            victim = e;
+        }
+    }
+
+    if (best && best_diff == 0) {
+        *kind = CEC_TX_CACHE_HIT;
+    } else if (best) {
+        for (size_t i = 0; i < len; i++) {
+            if (best->bytes[i] != bytes[i]) {
+                cec_tx_encode_byte(&best->words[i * CEC_TX_WORDS_PER_BYTE], bytes[i]);
+                best->bytes[i] = bytes[i];
+            }
+        }
+        *kind = CEC_TX_CACHE_PATCH;
+    } else if (victim) {
+        best = victim;
+        cec_tx_encode(best, bytes, len);
+        *kind = CEC_TX_CACHE_MISS;
+    } else {
+        g_full++;
+        return -1;
+    }
+    best->used = ++g_cache_seq;
+    best->refs++;
+
+    cache_stats_t *cs = &g_stats[*kind];
+    uint32_t us = time_us_32() - t0;
+    cs->count++;
+    cs->sum_us += us;
+    if (us > cs->max_us) {
+        cs->max_us = us;
+    }
+    return (int)(best - g_cache);
+}
+
+const uint32_t *cec_tx_cache_words(int slot) {
+    return g_cache[slot].words;
+}
+
+void cec_tx_cache_release(int slot) {
+    if (slot >= 0 && slot < CEC_TX_CACHE_SLOTS && g_cache[slot].refs > 0) {
+        g_cache[slot].refs--;
+    }
+}
+
+void cec_tx_cache_dump(void) {
+    static const char *const names[CEC_TX_CACHE_KIND_COUNT] = { "hit", "patched", "encoded" };
+    printf("CEC TX frame cache (%d slots, prepared at queue time)\n", CEC_TX_CACHE_SLOTS);
+    for (int k = 0; k < CEC_TX_CACHE_KIND_COUNT; k++) {
+        const cache_stats_t *cs = &g_stats[k];
+        printf("  %-8s %6lu  avg=%lu us max=%lu us\n", names[k], (unsigned long)cs->count,
+               (unsigned long)(cs->count ? cs->sum_us / cs->count : 0), (unsigned long)cs->max_us);
+    }
+    printf("  no free slot %lu\n", (unsigned long)g_full);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "cec_rx.h"
+
+// 符号化済みフレームキャッシュ
+// 応答フレームは宛先ヘッダや状態バイト以外は毎回同じなので、PIO ワード列をスロットに残しておき、
+// 同じ長さで差が CEC_TX_PATCH_MAX バイト以下のフレームはそのバイトだけ書き換えて再利用する。
+// ワード列は送信キューへの投入時に用意し、送信完了までスロットを確保しておく
+// (バスの空きを確認してから Start ビットまでの間には何もしない)。
+// PIO に依存しないので、ホスト (tools/cec_replay の tx_bench) でも同じコードを計測できる。
+#define CEC_TX_CACHE_SLOTS    10   // 送信キュー (8) + 自己試験 + cec_tx_send が同時に確保しても足りる数
+#define CEC_TX_PATCH_MAX      2
+#define CEC_TX_WORDS_PER_BYTE 10   // データ 8 + EOM + ACK
+
+// シンボル1個分 (LOW→HIGH) の PIO ワード
+// X_low = low_us - 3, X_high = high_us - 4 (PIO 命令オーバーヘッド補正)
+#define CEC_TX_WORD(low_us, high_us) ((((uint32_t)(low_us) - 3u) << 16) | ((uint32_t)(high_us) - 4u))
+
+typedef enum {
+    CEC_TX_CACHE_HIT = 0,          // 一致
+    CEC_TX_CACHE_PATCH,            // 差分書き換え
+    CEC_TX_CACHE_MISS,             // LRU スロットに新規符号化
+    CEC_TX_CACHE_KIND_COUNT
+} cec_tx_cache_kind_t;
+
+// フレーム (len バイト) の PIO ワード列を用意してスロット番号を返す。
+// スロットは cec_tx_cache_release() まで書き換えられない (同じフレームなら共有する)。
+// 空きスロットがなければ -1
+int cec_tx_cache_acquire(const uint8_t *bytes, size_t len, cec_tx_cache_kind_t *kind);
+
+// スロットのワード列 (len * CEC_TX_WORDS_PER_BYTE 個)
+const uint32_t *cec_tx_cache_words(int slot);
+
+void cec_tx_cache_release(int slot);
+
+// 一致 / 差分書き換え / 新規符号化の回数と所要時間、空きなしの回数を出力
+void cec_tx_cache_dump(void);
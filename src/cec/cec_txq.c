@@ -0,0 +1,188 @@
+#include "cec_txq.h"
+#include "cec_tx.h"
+#include "cec_tx_cache.h"
+#include "cec_rx.h"
+#include "cec_stats.h"
+#include "log.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+typedef struct {
+    bool            used;
+    uint8_t         prio;
+    uint8_t         len;
+    uint8_t         attempts;
+    uint8_t         max_retries;
+    int8_t          slot;      // 符号化済みワード列 (cec_tx_cache)
+    uint8_t         bytes[CEC_MAX_FRAME_BYTES];
+    absolute_time_t queued;
+    absolute_time_t deadline;
+    absolute_time_t next_try;  // バックオフ明け
+    const char     *tag;
+    cec_txq_done_t  done;      // 完了通知 (NULL = なし)
+    void           *ctx;
+} txq_entry_t;
+
+typedef struct {
+    uint32_t sent;
+    uint32_t failed;
+    uint32_t retries;
+    uint32_t missed;      // デッドライン超過で完了した数
+    uint32_t dropped;     // キュー満杯で積めなかった数
+    uint32_t max_lat_us;  // キュー投入〜完了の最大
+} txq_stats_t;
+
+static txq_entry_t g_q[CEC_TXQ_DEPTH];
+static txq_stats_t g_stats[CEC_TXQ_PRIO_COUNT];
+
+// 全エントリが別々のフレームでも、自己試験と cec_tx_send の分が残ること
+#if CEC_TX_CACHE_SLOTS < CEC_TXQ_DEPTH + 2
+#error "CEC_TX_CACHE_SLOTS too small for CEC_TXQ_DEPTH"
+#endif
+
+static const uint32_t k_deadline_ms[CEC_TXQ_PRIO_COUNT] = {
+    [CEC_TXQ_PRIO_REPLY]     = CEC_TXQ_REPLY_DEADLINE_MS,
+    [CEC_TXQ_PRIO_BROADCAST] = CEC_TXQ_BROADCAST_DEADLINE_MS,
+};
+
+bool cec_txq_push(const uint8_t *bytes, size_t len, cec_txq_prio_t prio, const char *tag) {
+    return cec_txq_push_cb(bytes, len, prio, tag, CEC_TX_MAX_RETRIES, NULL, NULL);
+}
+
+bool cec_txq_push_cb(const uint8_t *bytes, size_t len, cec_txq_prio_t prio, const char *tag,
+                     uint8_t max_retries, cec_txq_done_t done, void *ctx) {
+    if (!bytes || len == 0 || len > CEC_MAX_FRAME_BYTES || prio >= CEC_TXQ_PRIO_COUNT) {
+        return false;
+    }
+
+    for (int i = 0; i < CEC_TXQ_DEPTH; i++) {
+        txq_entry_t *e = &g_q[i];
+        if (e->used) {
+            continue;
+        }
+        // ワード列はここで用意する (送信時はバスの空きを見たらすぐ Start ビット)
+        cec_tx_cache_kind_t kind;
+        int slot = cec_tx_cache_acquire(bytes, len, &kind);
+        if (slot < 0) {
+            break;
+        }
+        e->slot     = (int8_t)slot;
+        memcpy(e->bytes, bytes, len);
+        e->len      = (uint8_t)len;
+        e->prio     = (uint8_t)prio;
+        e->attempts = 0;
+        e->max_retries = max_retries;
+        e->tag      = tag;
+        e->done     = done;
+        e->ctx      = ctx;
+        e->queued   = get_absolute_time();
+        e->deadline = delayed_by_ms(e->queued, k_deadline_ms[prio]);
+        e->next_try = e->queued;
+        e->used     = true;
+        return true;
+    }
+
+    g_stats[prio].dropped++;
+    LOG_W("  CEC TXQ full, dropped %s\n", tag ? tag : "frame");
+    return false;
+}
+
+// 送信可能な最優先エントリ (優先度 → デッドライン順)
+static txq_entry_t *pick(absolute_time_t now) {
+    txq_entry_t *best = NULL;
+    for (int i = 0; i < CEC_TXQ_DEPTH; i++) {
+        txq_entry_t *e = &g_q[i];
+        if (!e->used || absolute_time_diff_us(now, e->next_try) > 0) {
+            continue;
+        }
+        if (!best || e->prio < best->prio
+            || (e->prio == best->prio && absolute_time_diff_us(e->deadline, best->deadline) > 0)) {
+            best = e;
+        }
+    }
+    return best;
+}
+
+static void complete(txq_entry_t *e, cec_tx_result_t result, absolute_time_t now) {
+    static const char *const names[] = { "OK", "FAIL", "NOT SENT" };
+    bool ok = result == CEC_TX_OK;
+    txq_stats_t *st = &g_stats[e->prio];
+    uint32_t lat_us = (uint32_t)absolute_time_diff_us(e->queued, now);
+    bool late = absolute_time_diff_us(e->deadline, now) > 0;
+
+    if (ok) {
+        st->sent++;
+    } else {
+        st->failed++;
+    }
+    st->retries += (uint32_t)(e->attempts - 1);
+    if (late) {
+        st->missed++;
+    }
+    if (lat_us > st->max_lat_us) {
+        st->max_lat_us = lat_us;
+    }
+
+    LOG_I("  CEC TX %s: %s (%u tries, %lu us%s)\n", e->tag ? e->tag : "frame", names[result],
+           e->attempts, (unsigned long)lat_us, late ? ", DEADLINE MISSED" : "");
+    e->used = false;
+    cec_tx_cache_release(e->slot);
+
+    // スロットを空けてから通知する (コールバック内で次のフレームを積めるように)
+    if (e->done) {
+        e->done(result, e->ctx);
+    }
+}
+
+bool cec_txq_service(void) {
+    absolute_time_t now = get_absolute_time();
+    txq_entry_t *e = pick(now);
+    if (!e) {
+        return false;
+    }
+
+    // バスアイドル確認 (ブロックしない — 足りなければ次の周期で再試行)
+    if (cec_rx_idle_us(CEC_BUS_MAIN) < CEC_TX_IDLE_US) {
+        return false;
+    }
+
+    if (e->attempts > 0) {
+        cec_stats_tx_retry();
+    }
+    cec_tx_result_t result = cec_tx_send_bytes(CEC_BUS_MAIN, e->bytes, e->len, cec_tx_cache_words(e->slot));
+    e->attempts++;
+    now = get_absolute_time();
+
+    if (result == CEC_TX_OK || e->attempts > e->max_retries) {
+        complete(e, result, now);
+    } else {
+        e->next_try = delayed_by_us(now, (uint64_t)CEC_TXQ_BACKOFF_US * e->attempts);
+    }
+    return true;
+}
+
+static bool has_prio(cec_txq_prio_t prio) {
+    for (int i = 0; i < CEC_TXQ_DEPTH; i++) {
+        if (g_q[i].used && g_q[i].prio <= prio) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool cec_txq_empty(void) {
+    return !has_prio(CEC_TXQ_PRIO_COUNT);
+}
+
+void cec_txq_dump_stats(void) {
+    static const char *const names[CEC_TXQ_PRIO_COUNT] = { "reply", "broadcast" };
+    printf("CEC TXQ stats\n");
+    for (int p = 0; p < CEC_TXQ_PRIO_COUNT; p++) {
+        const txq_stats_t *st = &g_stats[p];
+        printf("  %-9s sent=%lu failed=%lu retries=%lu missed=%lu dropped=%lu max=%lu us (deadline %lu ms)\n",
+               names[p], (unsigned long)st->sent, (unsigned long)st->failed, (unsigned long)st->retries,
+               (unsigned long)st->missed, (unsigned long)st->dropped, (unsigned long)st->max_lat_us,
+               (unsigned long)k_deadline_ms[p]);
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "cec_tx.h"
+
+// CEC 送信キュー (優先度 + デッドライン付き)
+// 自分宛て要求への応答を最優先、同じ優先度内はデッドラインの早い順に送る。
+// NACK 時はバックオフしてリトライし、その間は他のエントリを先に送る。
+
+typedef enum {
+    CEC_TXQ_PRIO_REPLY = 0,   // directed 応答 (Report Power Status, Feature Abort 等)
+    CEC_TXQ_PRIO_BROADCAST,   // ブロードキャスト / アナウンス
+    CEC_TXQ_PRIO_COUNT
+} cec_txq_prio_t;
+
+#define CEC_TXQ_DEPTH                 8
+#define CEC_TXQ_REPLY_DEADLINE_MS     200   // CEC 仕様の応答時間
+#define CEC_TXQ_BROADCAST_DEADLINE_MS 1000
+#define CEC_TXQ_BACKOFF_US            (3 * 2400)  // リトライ間隔 (3 ビット期間 × 試行回数)
+
+// キューに積む (満杯なら false)。tag はログ用 (文字列リテラルを渡すこと)
+bool cec_txq_push(const uint8_t *bytes, size_t len, cec_txq_prio_t prio, const char *tag);
+
+// 完了通知: 最後の試行の結果 (CEC_TX_OK で終わらなければリトライを使い切った)。
+// CEC_TX_NOT_SENT なら一度もまともに送れていない (バス使用中 / 衝突) — NACK と区別すること
+typedef void (*cec_txq_done_t)(cec_tx_result_t result, void *ctx);
+
+// リトライ回数と完了通知を指定して積む (ポーリングのように NACK も意味のある結果になるフレーム用)
+bool cec_txq_push_cb(const uint8_t *bytes, size_t len, cec_txq_prio_t prio, const char *tag,
+                     uint8_t max_retries, cec_txq_done_t done, void *ctx);
+
+// 送信可能なエントリを1つ送る。送信を試みたら true (ブロックは 1 フレーム分のみ)
+bool cec_txq_service(void);
+
+bool cec_txq_empty(void);
+
+// 統計 (送信数 / 失敗 / リトライ / デッドライン超過 / 最大レイテンシ) を出力
+void cec_txq_dump_stats(void);
@@ -0,0 +1,124 @@
+#include "clock_scale.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include "cec/cec_tx.h"
+#include "cec/cec_rx.h"
+#include "ri/ri_tx.h"
+#include "ri/ri_rx.h"
+#include "led/led.h"
+
+#define CLOCK_IDLE_AFTER_MS 2000  // 最後の処理からこの時間で IDLE へ
+
+typedef struct {
+    uint64_t residency_us;
+    uint32_t entries;
+    uint32_t lat_max_us;   // このプロファイル中に計測した ISR レイテンシの最大
+} profile_stats_t;
+
+static uint32_t        g_hz[CLOCK_PROFILE_COUNT];
+static clock_profile_t g_profile = CLOCK_PROFILE_FULL;
+static uint64_t        g_entered_us;
+static absolute_time_t g_last_activity;
+static profile_stats_t g_stats[CLOCK_PROFILE_COUNT];
+static uint32_t        g_lat_seen = 0;
+
+static void clock_switch(clock_profile_t p) {
+    if (p == g_profile) {
+        return;
+    }
+
+    uint64_t now = time_us_64();
+    g_stats[g_profile].residency_us += now - g_entered_us;
+    g_entered_us = now;
+    g_stats[p].entries++;
+
+    // クロック切り替えと PIO 分周比の更新の間に割り込みを挟まない
+    uint32_t save = save_and_disable_interrupts();
+    if (p == CLOCK_PROFILE_IDLE) {
+        clock_configure(clk_sys,
+                        CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX,
+                        CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB,
+                        g_hz[CLOCK_PROFILE_IDLE], g_hz[CLOCK_PROFILE_IDLE]);
+    } else {
+        clock_configure(clk_sys,
+                        CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX,
+                        CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS,
+                        g_hz[CLOCK_PROFILE_FULL], g_hz[CLOCK_PROFILE_FULL]);
+    }
+    cec_tx_clock_changed();
+    ri_tx_clock_changed();
+    ri_rx_clock_changed();
+    led_clock_changed();
+    restore_interrupts(save);
+
+    g_profile = p;
+}
+
+void clock_scale_init(void) {
+    g_hz[CLOCK_PROFILE_FULL] = clock_get_hz(clk_sys);
+    g_hz[CLOCK_PROFILE_IDLE] = clock_get_hz(clk_usb);  // PLL_USB 出力 (48 MHz)
+    g_profile = CLOCK_PROFILE_FULL;
+    g_entered_us = time_us_64();
+    g_last_activity = get_absolute_time();
+    g_stats[CLOCK_PROFILE_FULL].entries = 1;
+}
+
+void clock_scale_activity(void) {
+    g_last_activity = get_absolute_time();
+    clock_switch(CLOCK_PROFILE_FULL);
+}
+
+void clock_scale_service(bool busy) {
+    // 直近の ISR レイテンシ計測値を現在のプロファイルに計上
+    uint32_t count, last;
+    cec_rx_latency_sample(&count, &last);
+    if (count != g_lat_seen) {
+        g_lat_seen = count;
+        if (last > g_stats[g_profile].lat_max_us) {
+            g_stats[g_profile].lat_max_us = last;
+        }
+    }
+
+    if (busy || ri_tx_busy()) {
+        clock_scale_activity();
+        return;
+    }
+    if (g_profile == CLOCK_PROFILE_IDLE) {
+        return;
+    }
+    if (absolute_time_diff_us(g_last_activity, get_absolute_time()) > (int64_t)CLOCK_IDLE_AFTER_MS * 1000) {
+        clock_switch(CLOCK_PROFILE_IDLE);
+    }
+}
+
+void clock_scale_dump(void) {
+    static const char *const names[CLOCK_PROFILE_COUNT] = { "full", "idle" };
+
+    uint64_t res[CLOCK_PROFILE_COUNT];
+    uint64_t total = 0;
+    for (int p = 0; p < CLOCK_PROFILE_COUNT; p++) {
+        res[p] = g_stats[p].residency_us;
+        if (p == (int)g_profile) {
+            res[p] += time_us_64() - g_entered_us;
+        }
+        total += res[p];
+    }
+
+    // 動的電力は clk_sys にほぼ比例するとして FULL 比で推定 (実測ではない)
+    uint64_t weighted = 0;
+    printf("Clock profiles (current: %s)\n", names[g_profile]);
+    for (int p = 0; p < CLOCK_PROFILE_COUNT; p++) {
+        uint32_t pct = total ? (uint32_t)(res[p] * 100 / total) : 0;
+        weighted += res[p] * (g_hz[p] / 1000u);
+        printf("  %-4s %3lu MHz  time %lu ms (%lu%%)  entries %lu  ISR latency max %lu us  rel. power ~%lu%%\n",
+               names[p], (unsigned long)(g_hz[p] / 1000000u), (unsigned long)(res[p] / 1000), (unsigned long)pct,
+               (unsigned long)g_stats[p].entries, (unsigned long)g_stats[p].lat_max_us,
+               (unsigned long)((uint64_t)g_hz[p] * 100 / g_hz[CLOCK_PROFILE_FULL]));
+    }
+    if (total) {
+        printf("  average clk_sys load vs always-full: ~%lu%% (estimate)\n",
+               (unsigned long)(weighted * 100 / (total * (g_hz[CLOCK_PROFILE_FULL] / 1000u))));
+    }
+}
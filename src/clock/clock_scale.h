@@ -0,0 +1,26 @@
+#pragma once
+#include <stdbool.h>
+
+// 実行時クロックスケーリング
+// アイドル中は clk_sys を PLL_USB (48 MHz) に切り替えて消費電力を下げ、
+// CEC フレーム処理や送信が発生したら PLL_SYS (既定速度) に戻す。
+// 切り替えのたびに PIO (CEC TX / RI TX / WS2812) の分周比を再計算する。
+// CEC RX / ACK / RI の µs 計時はシステムタイマー (clk_ref 基準) なので clk_sys の影響を受けない。
+
+typedef enum {
+    CLOCK_PROFILE_FULL = 0,  // PLL_SYS (125 MHz / 150 MHz)
+    CLOCK_PROFILE_IDLE,      // PLL_USB (48 MHz)
+    CLOCK_PROFILE_COUNT
+} clock_profile_t;
+
+// 起動時の clk_sys を FULL として記録
+void clock_scale_init(void);
+
+// 処理が発生した — 即座に FULL に戻す (メインループから呼ぶこと)
+void clock_scale_activity(void);
+
+// メインループで毎周期呼ぶ — 一定時間アイドルで送信も止まっていれば IDLE に落とす
+void clock_scale_service(bool busy);
+
+// プロファイルごとの滞在時間 / 切り替え回数 / ISR レイテンシ / 推定電力を出力
+void clock_scale_dump(void);
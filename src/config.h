@@ -7,13 +7,73 @@
 // ---- GPIO ピン割り当て ----
 
 #define CEC_GPIO   1   // HDMI CEC ライン (オープンドレイン)
-#define RI_GPIO    0   // ONKYO RI ライン (3.5mm Tip)
+#define RI_GPIO    0   // ONKYO RI ライン (3.5mm Tip) — RI 出力 0
+
+// ---- CEC バス ----
+// 先頭は CEC_GPIO = メインバス (ブリッジが応答・送信するのはこのバスだけ)。
+// 追加した GPIO はモニタ用の受信専用バス (最大 3 本まで): ACK も送信もせず、PIO SM も使わない。
+// 復号したフレームはデバッグログへ、バスごとの ISR 負荷はコンソールの 'l' で確認できる。
+// 別ゾーンへのブリッジ (ゾーンごとの応答・送信) はまだない
+// 例: { CEC_GPIO, 2, 3 }
+
+#define CEC_BUS_GPIOS { CEC_GPIO }
+
+// ---- RI 出力 ----
+// RI_GPIO から連続する GPIO を RI 出力として使う (最大 4)。
+// 2 台目以降を使う場合は CEC_GPIO と重ならないよう RI_GPIO を移動すること。
+// RI_OUTPUT_ROUTES: 出力ごとに送るコマンド種別 (RI_ROUTE_POWER / VOLUME / INPUT / ALL)
+// 例: アンプ + 別ゾーンのレシーバ → { RI_ROUTE_ALL, RI_ROUTE_POWER }
+// RI_OUTPUT_PROTOS / RI_OUTPUT_CODESETS: 出力ごとのタイミングとコード表 (src/ri/ri_proto.h)
+// 既定以外の機種は RI_PROTO_CUSTOM / RI_CODESET_CUSTOM を選び、下の RI_CUSTOM_* を定義する
+
+#define RI_OUTPUT_COUNT    1
+#define RI_OUTPUT_ROUTES   { RI_ROUTE_ALL }
+#define RI_OUTPUT_PROTOS   { RI_PROTO_ONKYO }
+#define RI_OUTPUT_CODESETS { RI_CODESET_AMP }
+
+// 例: 16 bit の機種 (パルス数は repeat 込みで RI_PROTO_MAX_PULSES 以内)
+// #define RI_CUSTOM_PROTO { 3000, 1000, 1000, 2000, 1000, 1000, 20000, 16, 1 }
+// (header mark / space, bit mark, one space, zero space, footer mark, gap [µs], bits, repeat)
+// コードは ri_cmd_t の順 (Input Sel, Vol Up, Vol Down, Mute, Unmute, Power OFF, Power ON)。
+// 対応しないコマンドは RI_CODE_NONE
+// #define RI_CUSTOM_CODES { 0x1A0, 0x1A2, 0x1A3, 0x1A4, 0x1A5, 0x1AE, 0x1AF }
+
+// ---- RI 受信 ----
+// アンプや他の RI 機器が送ったコマンドを受信して電源 / 音量 / ミュートの状態を合わせる (-1 で無効)。
+// RI_GPIO と同じ番号にすると RI 出力をオープンドライブ (mark だけ駆動、space は内部プルダウン) にして
+// 同じ線で受信する。別の GPIO を使う場合はアンプのもう一方の RI 端子などから 3.3V 以下で入力すること。
+// 復号には RI 出力 0 のプロトコルとコードセットを使う
+
+#define RI_RX_GPIO -1
+
+// ---- 音量 ----
+// RI Vol Up / Down 1 回で変わる音量 (CEC の 0-100 スケール換算)。
+// Set Audio Volume Level (絶対音量) はこの刻みで RI ステップ数に換算される
+
+#define RI_VOL_STEP 2
+
+// ---- 自己試験 ----
+// 1 にすると起動時に CEC 送受信タイミングの自己試験 (約 0.3 秒) を行い、仕様外なら CEC TX LED を 3 回点滅
+
+#define CEC_BIST_AT_BOOT 1
+
+// ---- 省電力 ----
+// 1 にするとアイドル中 clk_sys を 48 MHz (PLL_USB) に落とし、処理時だけ既定速度に戻す
+
+#define CLOCK_SCALING 1
 
 // ---- インジケータ LED ----
 // 0 を設定すると LED 機能を無効化 (通常の Pico / Pico 2 向け)
 // XIAO RP2040 の場合: GP17=Red, GP16=Green, GP25=Blue
-// WS2812 のようなアドレサブル LED は非対応
+// PWM で駆動する (アクティブ LOW)
 
 #define LED_CEC_RX_GPIO 17  // CEC 受信インジケータ
 #define LED_CEC_TX_GPIO 16  // CEC 送信インジケータ
 #define LED_RI_TX_GPIO  25  // RI 送信インジケータ
+
+// WS2812 のようなアドレサブル LED (1 灯) を使う場合はデータ GPIO を指定する。
+// 0 以外なら上記 3 つの代わりに CEC RX=Red / CEC TX=Green / RI TX=Blue で表示する。
+// 電源制御ピンがあるボード (XIAO RP2040: GP11) は LED_WS2812_POWER_GPIO に指定する (0 = なし)
+
+#define LED_WS2812_GPIO       0
+#define LED_WS2812_POWER_GPIO 0
@@ -0,0 +1,119 @@
+#include "stall.h"
+#include "log.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/watchdog.h"
+
+#define STALL_MAGIC 0x5354414Cu  // "STAL"
+#define STALL_DEPTH 4            // 記録するネストの深さ
+
+typedef struct {
+    uint32_t magic;
+    uint32_t depth;                      // 現在のネスト数 (STALL_DEPTH 超過分も数える)
+    uint8_t  stack[STALL_DEPTH];         // ブレッドクラム (外側から順)
+    uint32_t enter_us[STALL_DEPTH];
+    uint32_t max_us[STALL_SITE_COUNT];   // 区間ごとの最長時間
+    uint32_t loop_max_us;                // メインループ 1 周期の最長時間
+    uint32_t loop_last_us;
+} stall_rec_t;
+
+// リセットでクリアされない RAM (ウォッチドッグリセット後も残る)
+static stall_rec_t __uninitialized_ram(g_rec);
+
+static stall_rec_t g_prev;
+static bool        g_prev_valid = false;
+
+static const char *site_name(uint8_t site) {
+    switch (site) {
+    case STALL_SITE_NONE:        return "main loop";
+    case STALL_SITE_CEC_HANDLE:  return "CEC handle";
+    case STALL_SITE_CEC_TX:      return "CEC TX";
+    case STALL_SITE_CEC_TX_WAIT: return "CEC TX PIO wait";
+    case STALL_SITE_RI_TX:       return "RI TX";
+    case STALL_SITE_LOG:         return "USB log";
+    default:                     return "?";
+    }
+}
+
+static bool rec_valid(const stall_rec_t *r) {
+    if (r->magic != STALL_MAGIC) {
+        return false;
+    }
+    for (uint32_t i = 0; i < r->depth && i < STALL_DEPTH; i++) {
+        if (r->stack[i] >= STALL_SITE_COUNT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void stall_init(void) {
+    g_prev_valid = rec_valid(&g_rec);
+    if (g_prev_valid) {
+        g_prev = g_rec;
+    }
+
+    g_rec = (stall_rec_t){0};
+    g_rec.magic = STALL_MAGIC;
+}
+
+bool stall_report(void) {
+    if (!g_prev_valid || !watchdog_caused_reboot()) {
+        return false;
+    }
+
+    LOG_E("STALL: watchdog reset, breadcrumb:");
+    if (g_prev.depth == 0) {
+        LOG_E(" %s", site_name(STALL_SITE_NONE));
+    }
+    for (uint32_t i = 0; i < g_prev.depth && i < STALL_DEPTH; i++) {
+        LOG_E("%s%s", i ? " > " : " ", site_name(g_prev.stack[i]));
+    }
+    if (g_prev.depth > STALL_DEPTH) {
+        LOG_E(" > ... (depth %u)", (unsigned)g_prev.depth);
+    }
+    LOG_E("\n");
+
+    LOG_E("STALL: longest main loop iteration %u us\n", (unsigned)g_prev.loop_max_us);
+    for (int i = STALL_SITE_CEC_HANDLE; i < STALL_SITE_COUNT; i++) {
+        if (g_prev.max_us[i]) {
+            LOG_E("STALL:   %-16s max %u us\n", site_name((uint8_t)i), (unsigned)g_prev.max_us[i]);
+        }
+    }
+    return true;
+}
+
+void stall_enter(stall_site_t site) {
+    uint32_t d = g_rec.depth;
+    if (d < STALL_DEPTH) {
+        g_rec.stack[d]    = (uint8_t)site;
+        g_rec.enter_us[d] = time_us_32();
+    }
+    g_rec.depth = d + 1;
+}
+
+void stall_leave(void) {
+    if (g_rec.depth == 0) {
+        return;
+    }
+
+    uint32_t d = --g_rec.depth;
+    if (d < STALL_DEPTH) {
+        uint32_t us = time_us_32() - g_rec.enter_us[d];
+        uint8_t site = g_rec.stack[d];
+        if (us > g_rec.max_us[site]) {
+            g_rec.max_us[site] = us;
+        }
+    }
+}
+
+void stall_loop_tick(void) {
+    uint32_t now = time_us_32();
+    if (g_rec.loop_last_us != 0) {
+        uint32_t us = now - g_rec.loop_last_us;
+        if (us > g_rec.loop_max_us) {
+            g_rec.loop_max_us = us;
+        }
+    }
+    g_rec.loop_last_us = now;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+// ストールプロファイラ
+// メインループと TX/RI 処理の「今どこにいるか」(ブレッドクラム) と区間ごとの最長時間を
+// noinit RAM に記録する。ウォッチドッグリセット後も内容が残るので、次回起動時に報告できる。
+
+typedef enum {
+    STALL_SITE_NONE = 0,     // メインループ (どの区間にもいない)
+    STALL_SITE_CEC_HANDLE,   // handle_cec_frame
+    STALL_SITE_CEC_TX,       // cec_tx_send (アイドル待ち + リトライ込み)
+    STALL_SITE_CEC_TX_WAIT,  // PIO の ACK シンボル完了待ち (pio_sm_get_pc)
+    STALL_SITE_RI_TX,        // ri_tx_send
+    STALL_SITE_LOG,          // USB printf
+    STALL_SITE_COUNT
+} stall_site_t;
+
+// 起動直後に1回呼ぶ — 前回ブートの記録を退避して今回分をリセット
+void stall_init(void);
+
+// 前回ブートの記録を出力 (ウォッチドッグリセットで再起動した場合のみ)。出力したら true
+bool stall_report(void);
+
+// 区間の出入り (ネスト可)
+void stall_enter(stall_site_t site);
+void stall_leave(void);
+
+// メインループの先頭で毎周期呼ぶ — 1周期の最長時間を記録
+void stall_loop_tick(void);
@@ -0,0 +1,17 @@
+#pragma once
+#include "pico/platform.h"
+
+// RAM 常駐ホットパス
+// CEC_HOT_PATH_RAM=1 (CMake オプション CEC_HOT_PATH_RAM) のとき、µs 精度が要る関数
+// (CEC RX ISR / ACK 応答 / TX シンボル送出 / RI DMA 割り込み) を SRAM に配置し、
+// XIP キャッシュミスによる遅延を避ける。
+
+#ifndef CEC_HOT_PATH_RAM
+#define CEC_HOT_PATH_RAM 0
+#endif
+
+#if CEC_HOT_PATH_RAM
+#define HOT_FUNC(name) __not_in_flash_func(name)
+#else
+#define HOT_FUNC(name) name
+#endif
@@ -1,65 +1,229 @@
 #include "led.h"
+#include "ws2812.pio.h"
 #include "pico/stdlib.h"
 #include "pico/time.h"
+#include "hardware/pwm.h"
+#include "hardware/pio.h"
+#include "hardware/sync.h"
 
-#define LED_FLASH_MS 80  // フラッシュ点灯時間 (ms)
+#define LED_TICK_MS        10   // パターン進行周期 (タイマー割り込み)
+#define LED_FLASH_MS       80   // フラッシュ点灯時間 (ms)
+#define LED_ERR_ON_MS      200  // エラーコード: 1 回の点灯時間
+#define LED_ERR_OFF_MS     200  // エラーコード: 点滅間の消灯時間
+#define LED_ERR_PAUSE_MS   1000 // エラーコード: 繰り返し間の休止
+#define LED_ERR_REPEAT     3    // エラーコード: 繰り返し回数
+#define LED_PWM_WRAP       4095 // PWM 分解能 (12 bit)
+#define LED_LEVEL_MAX      255
 
+typedef enum {
+    LED_PAT_OFF = 0,
+    LED_PAT_FLASH,
+    LED_PAT_FADE,
+    LED_PAT_ERROR,
+} led_pat_t;
+
+typedef struct {
+    volatile uint8_t pat;
+    volatile uint8_t level;   // 0..255
+    uint8_t          code;    // エラーコード (点滅回数)
+    uint16_t         tick;    // パターン内の経過 tick
+} led_state_t;
+
+typedef enum { LED_BACKEND_NONE, LED_BACKEND_PWM, LED_BACKEND_WS2812 } led_backend_t;
+
+static led_backend_t g_backend = LED_BACKEND_NONE;
 static uint g_gpio[LED_CH_COUNT];
-static bool g_enabled = false;
-static absolute_time_t g_off_time[LED_CH_COUNT];
-static bool g_lit[LED_CH_COUNT];
+static led_state_t g_led[LED_CH_COUNT];
+
+static PIO  g_pio;
+static uint g_sm;
+static uint g_prog_offset;
+
+static repeating_timer_t g_timer;
+static volatile bool     g_timer_running = false;
+
+// ---- 出力 ----
+
+// WS2812: チャンネル → 色 (CEC RX=Red, CEC TX=Green, RI TX=Blue)
+static void ws2812_put(void) {
+    uint32_t r = g_led[LED_CH_CEC_RX].level;
+    uint32_t g = g_led[LED_CH_CEC_TX].level;
+    uint32_t b = g_led[LED_CH_RI_TX].level;
+    if (!pio_sm_is_tx_fifo_full(g_pio, g_sm)) {
+        pio_sm_put(g_pio, g_sm, (g << 24) | (r << 16) | (b << 8));
+    }
+}
+
+static void led_apply(void) {
+    switch (g_backend) {
+    case LED_BACKEND_PWM:
+        for (int i = 0; i < LED_CH_COUNT; i++) {
+            // ガンマ補正 (level^2) + アクティブ LOW
+            uint32_t v = ((uint32_t)g_led[i].level * g_led[i].level) >> 4;
+            pwm_set_gpio_level(g_gpio[i], (uint16_t)(LED_PWM_WRAP - v));
+        }
+        break;
+    case LED_BACKEND_WS2812:
+        ws2812_put();
+        break;
+    default:
+        break;
+    }
+}
+
+// ---- パターン進行 (タイマー割り込み) ----
+
+// 1 tick 進める。パターン継続中なら true
+static bool led_step(led_state_t *s) {
+    switch (s->pat) {
+    case LED_PAT_FLASH:
+        if (++s->tick >= LED_FLASH_MS / LED_TICK_MS) {
+            s->level = 0;
+            s->pat = LED_PAT_OFF;
+        }
+        break;
+
+    case LED_PAT_FADE:
+        // 指数減衰 (約 300 ms で消灯)
+        s->level = (uint8_t)((s->level * 7u) / 8u);
+        if (s->level < 4) {
+            s->level = 0;
+            s->pat = LED_PAT_OFF;
+        }
+        break;
+
+    case LED_PAT_ERROR: {
+        // 1 周期 = code × (ON + OFF) + PAUSE
+        uint32_t on    = LED_ERR_ON_MS / LED_TICK_MS;
+        uint32_t blink = (LED_ERR_ON_MS + LED_ERR_OFF_MS) / LED_TICK_MS;
+        uint32_t cycle = s->code * blink + LED_ERR_PAUSE_MS / LED_TICK_MS;
+        uint32_t t = ++s->tick;
+        if (t >= cycle * LED_ERR_REPEAT) {
+            s->level = 0;
+            s->pat = LED_PAT_OFF;
+            break;
+        }
+        t %= cycle;
+        bool lit = t < s->code * blink && (t % blink) < on;
+        s->level = lit ? LED_LEVEL_MAX : 0;
+        break;
+    }
+
+    default:
+        return false;
+    }
+    return s->pat != LED_PAT_OFF;
+}
+
+static bool led_timer_cb(repeating_timer_t *t) {
+    (void)t;
+    bool active = false;
+    for (int i = 0; i < LED_CH_COUNT; i++) {
+        active |= led_step(&g_led[i]);
+    }
+    led_apply();
+    if (!active) {
+        g_timer_running = false;
+    }
+    return active;
+}
+
+// パターンを設定して即時反映、必要ならタイマーを起動
+static void led_start(led_ch_t ch, led_pat_t pat, uint8_t code) {
+    if (g_backend == LED_BACKEND_NONE || ch >= LED_CH_COUNT) {
+        return;
+    }
+
+    uint32_t save = save_and_disable_interrupts();
+    led_state_t *s = &g_led[ch];
+    // エラーコード表示中はフラッシュ / フェードで上書きしない
+    if (s->pat == LED_PAT_ERROR && pat != LED_PAT_ERROR) {
+        restore_interrupts(save);
+        return;
+    }
+    s->pat   = (uint8_t)pat;
+    s->tick  = 0;
+    s->code  = code;
+    s->level = (pat == LED_PAT_OFF) ? 0 : LED_LEVEL_MAX;
+    led_apply();
 
-// アクティブ LOW: LOW で点灯、HIGH で消灯
-static inline void led_on(uint gpio) {
-    gpio_put(gpio, 0);
+    bool start = !g_timer_running && pat != LED_PAT_OFF;
+    if (start) {
+        g_timer_running = true;
+    }
+    restore_interrupts(save);
+
+    if (start) {
+        add_repeating_timer_ms(-LED_TICK_MS, led_timer_cb, NULL, &g_timer);
+    }
 }
 
-static inline void led_off(uint gpio) {
-    gpio_put(gpio, 1);
+// ---- 初期化 ----
+
+static void led_init_pwm(uint gpio) {
+    pwm_config c = pwm_get_default_config();
+    pwm_config_set_wrap(&c, LED_PWM_WRAP);
+    gpio_set_function(gpio, GPIO_FUNC_PWM);
+    pwm_init(pwm_gpio_to_slice_num(gpio), &c, true);
+    pwm_set_gpio_level(gpio, LED_PWM_WRAP);  // アクティブ LOW: 消灯
 }
 
-void led_init(uint gpio_cec_rx, uint gpio_cec_tx, uint gpio_ri_tx) {
+void led_init(uint gpio_cec_rx, uint gpio_cec_tx, uint gpio_ri_tx, uint gpio_ws2812) {
     g_gpio[LED_CH_CEC_RX] = gpio_cec_rx;
     g_gpio[LED_CH_CEC_TX] = gpio_cec_tx;
     g_gpio[LED_CH_RI_TX]  = gpio_ri_tx;
 
+    for (int i = 0; i < LED_CH_COUNT; i++) {
+        g_led[i] = (led_state_t){0};
+    }
+
+    if (gpio_ws2812 != 0) {
+        if (!pio_claim_free_sm_and_add_program_for_gpio_range(
+                &ws2812_program, &g_pio, &g_sm, &g_prog_offset,
+                gpio_ws2812, 1, true)) {
+            panic("LED: no free PIO SM");
+        }
+        ws2812_program_init(g_pio, g_sm, g_prog_offset, gpio_ws2812);
+        g_backend = LED_BACKEND_WS2812;
+        led_apply();
+        return;
+    }
+
     // いずれかが 0 なら無効
     if (gpio_cec_rx == 0 || gpio_cec_tx == 0 || gpio_ri_tx == 0) {
-        g_enabled = false;
+        g_backend = LED_BACKEND_NONE;
         return;
     }
 
-    g_enabled = true;
-
     for (int i = 0; i < LED_CH_COUNT; i++) {
-        gpio_init(g_gpio[i]);
-        gpio_set_dir(g_gpio[i], true);
-        led_off(g_gpio[i]);
-        g_lit[i] = false;
-        g_off_time[i] = nil_time;
+        led_init_pwm(g_gpio[i]);
     }
+    g_backend = LED_BACKEND_PWM;
 }
 
-void led_flash(led_ch_t ch) {
-    if (!g_enabled || ch >= LED_CH_COUNT) {
-        return;
+void led_clock_changed(void) {
+    // PWM は周期が変わるだけで輝度 (デューティ比) は変わらない
+    if (g_backend == LED_BACKEND_WS2812) {
+        pio_sm_set_clkdiv(g_pio, g_sm, ws2812_clkdiv());
     }
+}
 
-    led_on(g_gpio[ch]);
-    g_lit[ch] = true;
-    g_off_time[ch] = make_timeout_time_ms(LED_FLASH_MS);
+void led_flash(led_ch_t ch) {
+    led_start(ch, LED_PAT_FLASH, 0);
 }
 
-void led_update(void) {
-    if (!g_enabled) {
-        return;
-    }
+void led_fade(led_ch_t ch) {
+    led_start(ch, LED_PAT_FADE, 0);
+}
 
-    absolute_time_t now = get_absolute_time();
-    for (int i = 0; i < LED_CH_COUNT; i++) {
-        if (g_lit[i] && absolute_time_diff_us(now, g_off_time[i]) <= 0) {
-            led_off(g_gpio[i]);
-            g_lit[i] = false;
+void led_error_code(led_ch_t ch, uint8_t code) {
+    if (code == 0) {
+        // エラー表示を解除 (上書き禁止を外してから消灯)
+        if (ch < LED_CH_COUNT) {
+            g_led[ch].pat = LED_PAT_OFF;
         }
+        led_start(ch, LED_PAT_OFF, 0);
+        return;
     }
+    led_start(ch, LED_PAT_ERROR, code);
 }
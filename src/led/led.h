@@ -1,5 +1,6 @@
 #pragma once
 #include <stdbool.h>
+#include <stdint.h>
 #include "pico/types.h"
 
 // LED チャンネル
@@ -11,10 +12,19 @@ typedef enum {
 } led_ch_t;
 
 // 初期化 (GPIO ピン番号を指定。0 なら無効化)
-void led_init(uint gpio_cec_rx, uint gpio_cec_tx, uint gpio_ri_tx);
+// gpio_ws2812 が 0 以外なら 3 チャンネルを WS2812 1 灯の R/G/B に割り当てる (gpio_cec_rx 等は無視)
+void led_init(uint gpio_cec_rx, uint gpio_cec_tx, uint gpio_ri_tx, uint gpio_ws2812);
 
-// 指定チャンネルを一瞬フラッシュ (メインループで消灯管理)
+// clk_sys 変更後に WS2812 の PIO 分周比を再計算
+void led_clock_changed(void);
+
+// 指定チャンネルを一瞬フラッシュ (80 ms)
 void led_flash(led_ch_t ch);
 
-// メインループで毎周期呼ぶ — タイムアウトした LED を消灯
-void led_update(void);
+// 点灯してからフェードアウト
+void led_fade(led_ch_t ch);
+
+// エラーコード表示: code 回点滅 → 休止 を数回繰り返す (0 で停止)
+void led_error_code(led_ch_t ch, uint8_t code);
+
+// NOTE: 点灯パターンはタイマー割り込みで進むため、メインループでのポーリングは不要
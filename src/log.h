@@ -0,0 +1,28 @@
+#pragma once
+#include <stdio.h>
+
+// コンパイル時ログレベル
+// LOG_LEVEL (CMake キャッシュ変数 LOG_LEVEL) 未満のログは呼び出しごと消える。
+// 引数は型チェックだけ行われ、評価もフォーマット文字列の格納もされない。
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3   // 受信フレーム / RI アクション / 送信結果
+#define LOG_LEVEL_DEBUG 4   // フレームの詳細 (opcode 名、応答内容など)
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+// USB stdio を使うか (0 = 省サイズビルド: デバッグコンソールと USB 接続待ちも外す)
+#ifndef LOG_STDIO
+#define LOG_STDIO 1
+#endif
+
+#define LOG_AT(level, ...) do { if (LOG_LEVEL >= (level)) printf(__VA_ARGS__); } while (0)
+
+#define LOG_E(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_W(...) LOG_AT(LOG_LEVEL_WARN,  __VA_ARGS__)
+#define LOG_I(...) LOG_AT(LOG_LEVEL_INFO,  __VA_ARGS__)
+#define LOG_D(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
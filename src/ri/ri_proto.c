@@ -0,0 +1,105 @@
+#include "ri_proto.h"
+#include "ri_code.h"
+#include "config.h"
+
+static const ri_proto_t k_protos[RI_PROTO_COUNT] = {
+    [RI_PROTO_ONKYO] = {
+        .header_mark_us  = 3000,
+        .header_space_us = 1000,
+        .bit_mark_us     = 1000,
+        .one_space_us    = 2000,
+        .zero_space_us   = 1000,
+        .footer_mark_us  = 1000,
+        .gap_us          = 20000,
+        .bits            = 12,
+        .repeat          = 1,
+    },
+#ifdef RI_CUSTOM_PROTO
+    [RI_PROTO_CUSTOM] = RI_CUSTOM_PROTO,
+#else
+    [RI_PROTO_CUSTOM] = {
+        .header_mark_us  = 3000,
+        .header_space_us = 1000,
+        .bit_mark_us     = 1000,
+        .one_space_us    = 2000,
+        .zero_space_us   = 1000,
+        .footer_mark_us  = 1000,
+        .gap_us          = 20000,
+        .bits            = 12,
+        .repeat          = 1,
+    },
+#endif
+};
+
+// 組み込みはプリメインアンプのコードだけ (レシーバー / Integra 等は未検証のため RI_CUSTOM_CODES で指定)
+#define RI_AMP_CODES { RI_INPUT_SEL, RI_VOL_UP, RI_VOL_DOWN, RI_MUTE, RI_UNMUTE, RI_POWER_OFF, RI_POWER_ON }
+
+static const uint16_t k_codes[RI_CODESET_COUNT][RI_CMD_COUNT] = {
+    [RI_CODESET_AMP] = RI_AMP_CODES,
+#ifdef RI_CUSTOM_CODES
+    [RI_CODESET_CUSTOM] = RI_CUSTOM_CODES,
+#else
+    [RI_CODESET_CUSTOM] = RI_AMP_CODES,
+#endif
+};
+
+static const char *const k_names[RI_CMD_COUNT] = {
+    [RI_CMD_INPUT_SEL] = "Input Sel",
+    [RI_CMD_VOL_UP]    = "Vol Up",
+    [RI_CMD_VOL_DOWN]  = "Vol Down",
+    [RI_CMD_MUTE]      = "Mute",
+    [RI_CMD_UNMUTE]    = "Unmute",
+    [RI_CMD_POWER_OFF] = "Power OFF",
+    [RI_CMD_POWER_ON]  = "Power ON",
+};
+
+const ri_proto_t *ri_proto_get(ri_proto_id_t id) {
+    return &k_protos[id < RI_PROTO_COUNT ? id : RI_PROTO_ONKYO];
+}
+
+uint16_t ri_code(ri_codeset_id_t set, ri_cmd_t cmd) {
+    if (set >= RI_CODESET_COUNT || cmd >= RI_CMD_COUNT) {
+        return RI_CODE_NONE;
+    }
+    return k_codes[set][cmd];
+}
+
+ri_cmd_t ri_cmd_from_code(ri_codeset_id_t set, uint16_t code) {
+    if (set >= RI_CODESET_COUNT) {
+        return RI_CMD_COUNT;
+    }
+    for (int c = 0; c < RI_CMD_COUNT; c++) {
+        if (k_codes[set][c] == code) {
+            return (ri_cmd_t)c;
+        }
+    }
+    return RI_CMD_COUNT;
+}
+
+const char *ri_cmd_name(ri_cmd_t cmd) {
+    return cmd < RI_CMD_COUNT ? k_names[cmd] : "?";
+}
+
+uint ri_proto_encode(const ri_proto_t *p, uint16_t code, uint16_t *us, uint max) {
+    uint n = 0;
+    for (uint r = 0; r < p->repeat; r++) {
+        if (n + 2u * p->bits + 4u > max) {
+            return 0;
+        }
+
+        // header
+        us[n++] = p->header_mark_us;
+        us[n++] = p->header_space_us;
+
+        // data (MSB first)
+        for (int i = p->bits - 1; i >= 0; i--) {
+            us[n++] = p->bit_mark_us;
+            us[n++] = ((code >> i) & 1u) ? p->one_space_us : p->zero_space_us;
+        }
+
+        // footer + フレーム間ギャップ
+        us[n++] = p->footer_mark_us;
+        us[n++] = p->gap_us;
+    }
+    return n;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/types.h"
+
+// RI プロトコル記述子 + コードテーブル
+// 機種ごとに異なるタイミングとコード体系を表で持ち、出力ごとに選べるようにする。
+// コマンドは送信前にパルス幅の配列 (mark / space 交互、mark から開始) に展開しておく。
+
+// 論理コマンド (コードセットで実際の RI コードに変換)
+typedef enum {
+    RI_CMD_INPUT_SEL = 0,
+    RI_CMD_VOL_UP,
+    RI_CMD_VOL_DOWN,
+    RI_CMD_MUTE,
+    RI_CMD_UNMUTE,
+    RI_CMD_POWER_OFF,
+    RI_CMD_POWER_ON,
+    RI_CMD_COUNT
+} ri_cmd_t;
+
+// タイミング (µs)
+typedef struct {
+    uint16_t header_mark_us;
+    uint16_t header_space_us;
+    uint16_t bit_mark_us;
+    uint16_t one_space_us;
+    uint16_t zero_space_us;
+    uint16_t footer_mark_us;
+    uint16_t gap_us;          // フレーム後の無信号区間
+    uint8_t  bits;            // データビット数 (MSB first、最大 16)
+    uint8_t  repeat;          // 1 コマンドあたりのフレーム送出回数
+} ri_proto_t;
+
+typedef enum {
+    RI_PROTO_ONKYO = 0,       // 12 bit, header 3 ms / 1 ms, gap 20 ms
+    RI_PROTO_CUSTOM,          // config.h の RI_CUSTOM_PROTO (未定義なら ONKYO と同じ)
+    RI_PROTO_COUNT
+} ri_proto_id_t;
+
+typedef enum {
+    RI_CODESET_AMP = 0,       // ri_code.h (プリメインアンプ用)
+    RI_CODESET_CUSTOM,        // config.h の RI_CUSTOM_CODES (未定義なら AMP と同じ)
+    RI_CODESET_COUNT
+} ri_codeset_id_t;
+
+// コマンドがない場合のコード
+#define RI_CODE_NONE 0xFFFF
+
+// 1 コマンド分のパルス数の上限 (12 bit なら 28 / フレーム → repeat 2 まで)
+#define RI_PROTO_MAX_PULSES 64
+
+const ri_proto_t *ri_proto_get(ri_proto_id_t id);
+
+// コードセット内のコード (なければ RI_CODE_NONE)
+uint16_t ri_code(ri_codeset_id_t set, ri_cmd_t cmd);
+
+// コード → コマンド (なければ RI_CMD_COUNT)
+ri_cmd_t ri_cmd_from_code(ri_codeset_id_t set, uint16_t code);
+
+const char *ri_cmd_name(ri_cmd_t cmd);
+
+// コードをパルス幅の配列に展開。戻り値は要素数 (入りきらなければ 0)
+uint ri_proto_encode(const ri_proto_t *p, uint16_t code, uint16_t *us, uint max);
@@ -0,0 +1,176 @@
+#include "ri_rx.h"
+#include "ri_rx.pio.h"
+#include "ri_tx.h"
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hot_path.h"
+
+// 幅の許容誤差: 基準の ±25% + 50 µs
+#define RI_RX_TOL(ref) ((uint32_t)(ref) / 4u + 50u)
+
+typedef struct {
+    uint32_t frames;    // 復号してキューに積んだ数
+    uint32_t echoes;    // 自分の送出中に受信 (捨てた)
+    uint32_t unknown;   // コードセットにないコード
+    uint32_t errors;    // フレーム途中で幅が合わなかった
+    uint32_t overruns;  // キュー満杯で捨てた
+    uint16_t last_unknown;
+} ri_rx_stats_t;
+
+static PIO  g_pio;
+static uint g_sm;
+
+static const ri_proto_t *g_proto;
+static ri_codeset_id_t   g_set;
+
+// フレーム組み立て (ISR 専用)
+static uint     g_idx;        // フレーム内のパルス番号 (偶数 = mark、0 = 待機中)
+static uint16_t g_code;
+static bool     g_tx_seen;    // フレーム中に RI TX が送出していた
+
+// 受信コマンドのリングバッファ (ISR → メインループ)
+static volatile uint8_t g_queue[RI_RX_QUEUE_DEPTH];
+static volatile uint8_t g_head;
+static volatile uint8_t g_tail;
+
+static ri_rx_stats_t g_stats;
+
+static inline bool ri_rx_near(uint32_t us, uint16_t ref) {
+    uint32_t tol = RI_RX_TOL(ref);
+    return us + tol >= ref && us <= ref + tol;
+}
+
+static void HOT_FUNC(ri_rx_frame_done)(void) {
+    if (g_tx_seen || ri_tx_busy()) {
+        g_stats.echoes++;
+        return;
+    }
+    ri_cmd_t cmd = ri_cmd_from_code(g_set, g_code);
+    if (cmd == RI_CMD_COUNT) {
+        g_stats.unknown++;
+        g_stats.last_unknown = g_code;
+        return;
+    }
+    uint8_t next = (uint8_t)((g_head + 1u) % RI_RX_QUEUE_DEPTH);
+    if (next == g_tail) {
+        g_stats.overruns++;
+        return;
+    }
+    g_queue[g_head] = (uint8_t)cmd;
+    g_head = next;
+    g_stats.frames++;
+}
+
+// mark / space 1 区間を処理
+static void HOT_FUNC(ri_rx_pulse)(bool mark, uint32_t us) {
+    const ri_proto_t *p = g_proto;
+    uint last = 2u + 2u * p->bits;   // footer mark のパルス番号
+
+    if (g_idx > 0 && mark != ((g_idx & 1u) == 0)) {
+        g_idx = 0;                   // FIFO 取りこぼしで mark / space がずれた
+        g_stats.errors++;
+    }
+
+    if (g_idx == 0) {
+        // header mark 待ち (space はフレーム間の無信号区間)
+        if (mark && ri_rx_near(us, p->header_mark_us)) {
+            g_idx     = 1;
+            g_code    = 0;
+            g_tx_seen = ri_tx_busy();
+        }
+        return;
+    }
+
+    bool ok;
+    if (g_idx == 1) {
+        ok = ri_rx_near(us, p->header_space_us);
+    } else if (g_idx == last) {
+        ok = ri_rx_near(us, p->footer_mark_us);
+        if (ok) {
+            g_idx = 0;
+            ri_rx_frame_done();
+            return;
+        }
+    } else if (mark) {
+        ok = ri_rx_near(us, p->bit_mark_us);
+    } else if (ri_rx_near(us, p->one_space_us)) {
+        g_code = (uint16_t)((g_code << 1) | 1u);
+        ok = true;
+    } else {
+        g_code = (uint16_t)(g_code << 1);
+        ok = ri_rx_near(us, p->zero_space_us);
+    }
+
+    if (ok) {
+        g_idx++;
+        g_tx_seen |= ri_tx_busy();
+    } else {
+        g_stats.errors++;
+        g_idx = 0;
+        // 幅の合わない mark が次のフレームの header だった場合
+        if (mark && ri_rx_near(us, p->header_mark_us)) {
+            g_idx     = 1;
+            g_code    = 0;
+            g_tx_seen = ri_tx_busy();
+        }
+    }
+}
+
+static void HOT_FUNC(ri_rx_irq)(void) {
+    while (!pio_sm_is_rx_fifo_empty(g_pio, g_sm)) {
+        uint32_t w = pio_sm_get(g_pio, g_sm);
+        bool mark = (w & 0x80000000u) == 0;
+        ri_rx_pulse(mark, mark ? w : ~w);
+    }
+}
+
+void ri_rx_init(uint gpio, ri_proto_id_t proto, ri_codeset_id_t set, bool shared) {
+    g_proto = ri_proto_get(proto);
+    g_set   = set;
+
+    // PIO / SM / プログラムを確保
+    uint offset;
+    if (!pio_claim_free_sm_and_add_program_for_gpio_range(
+            &ri_rx_program, &g_pio, &g_sm, &offset, gpio, 1, true)) {
+        panic("RI RX: no free PIO SM");
+    }
+    ri_rx_program_init(g_pio, g_sm, offset, gpio, shared);
+
+    // RX FIFO にデータが入ったら割り込み (IRQ 0 を他の PIO ユーザーと共有)
+    uint irq = pio_get_irq_num(g_pio, 0);
+    pio_set_irqn_source_enabled(g_pio, 0, pio_get_rx_fifo_not_empty_interrupt_source(g_sm), true);
+    irq_add_shared_handler(irq, ri_rx_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(irq, true);
+}
+
+void ri_rx_clock_changed(void) {
+    if (g_pio) {
+        pio_sm_set_clkdiv(g_pio, g_sm, ri_rx_clkdiv());
+    }
+}
+
+bool ri_rx_poll(ri_cmd_t *cmd) {
+    if (g_tail == g_head) {
+        return false;
+    }
+    *cmd = (ri_cmd_t)g_queue[g_tail];
+    g_tail = (uint8_t)((g_tail + 1u) % RI_RX_QUEUE_DEPTH);
+    return true;
+}
+
+void ri_rx_dump(void) {
+    uint32_t save = save_and_disable_interrupts();
+    ri_rx_stats_t st = g_stats;
+    restore_interrupts(save);
+
+    if (!g_pio) {
+        printf("RI RX: disabled\n");
+        return;
+    }
+    printf("RI RX: frames=%lu echoes=%lu unknown=%lu (last 0x%03X) errors=%lu overruns=%lu\n",
+           (unsigned long)st.frames, (unsigned long)st.echoes, (unsigned long)st.unknown,
+           (unsigned)st.last_unknown, (unsigned long)st.errors, (unsigned long)st.overruns);
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "pico/types.h"
+#include "ri_proto.h"
+
+// RI 受信 (アンプや他の RI 機器が送ったコマンドを PIO で復号)
+// mark / space 幅は PIO が計測し、FIFO 割り込みでフレームに組み立てる。
+// 自分の RI TX 送出中に受信したフレームは自己エコーとして捨てる。
+
+// 受信コマンドのキュー長
+#define RI_RX_QUEUE_DEPTH 8
+
+// gpio を RI 入力として初期化。proto / set で復号する (通常は RI 出力 0 と同じ)。
+// shared = true: gpio が RI 出力と同じピン (RI TX をオープンドライブで先に初期化しておくこと)。
+// false なら専用ピンとして入力 + プルダウンに設定する
+void ri_rx_init(uint gpio, ri_proto_id_t proto, ri_codeset_id_t set, bool shared);
+
+// clk_sys 変更後に PIO 分周比を再計算 (未初期化なら何もしない)
+void ri_rx_clock_changed(void);
+
+// 受信したコマンドを1つ取り出す。なければ false
+bool ri_rx_poll(ri_cmd_t *cmd);
+
+// 統計 (受信数 / 自己エコー / 未知コード / 復号エラー / 取りこぼし) を出力
+void ri_rx_dump(void);
@@ -1,62 +1,247 @@
 #include "ri_tx.h"
+#include "ri_tx.pio.h"
+#include <string.h>
 #include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "diag/stall.h"
+#include "hot_path.h"
 
-// RI protocol timing
-#define RI_HEADER_MARK_US    3000
-#define RI_HEADER_SPACE_US   1000
-#define RI_BIT_MARK_US       1000
-#define RI_BIT_ONE_SPACE_US  2000
-#define RI_BIT_ZERO_SPACE_US 1000
-#define RI_FOOTER_MARK_US    1000
-#define RI_FRAME_GAP_MS      20
-#define RI_FRAME_BITS        12
+// 1 コマンドの最大ワード数 (全出力のパルス境界がすべてずれた場合)
+#define RI_CMD_MAX_WORDS     (RI_TX_MAX_OUTPUTS * RI_PROTO_MAX_PULSES)
+// 送信バッファ (ダブルバッファ: DMA 中 / 積み込み中)
+#define RI_TX_BUF_WORDS      RI_CMD_MAX_WORDS
 
-static uint g_ri_gpio;
+// PIO の 1 区間の最短 (X = 0)
+#define RI_WORD_MIN_US       4u
 
-static inline void ri_mark_us(uint32_t us) {
-    gpio_put(g_ri_gpio, 1);
-    sleep_us(us);
+static PIO  g_pio;
+static uint g_sm;
+static uint g_prog_offset;
+static uint g_dma;
+
+static uint    g_count;
+static uint8_t g_routes[RI_TX_MAX_OUTPUTS];
+
+// 出力 × コマンドごとの展開済みパルス列 (mark / space 交互、mark から)
+static uint16_t g_pulses[RI_TX_MAX_OUTPUTS][RI_CMD_COUNT][RI_PROTO_MAX_PULSES];
+static uint8_t  g_npulses[RI_TX_MAX_OUTPUTS][RI_CMD_COUNT];   // 0 = この出力にコードなし
+
+static uint32_t g_words[RI_CMD_MAX_WORDS];                     // 合成用 (メインループ専用)
+
+static uint32_t         g_buf[2][RI_TX_BUF_WORDS];
+static volatile uint8_t g_stage = 0;       // 積み込み中のバッファ
+static volatile uint    g_fill = 0;        // 積み込み済みワード数
+static volatile bool    g_dma_running = false;
+
+// 区間ワード: レベルマスク + 長さ (X = us - 4)。出力間のずれで生じる 4 µs 未満の区間は切り上げ
+static inline uint32_t ri_word(uint8_t levels, uint32_t us) {
+    if (us < RI_WORD_MIN_US) {
+        us = RI_WORD_MIN_US;
+    }
+    return ((us - RI_WORD_MIN_US) << 4) | (levels & 0x0Fu);
+}
+
+// 積み込み済みバッファがあり DMA が空いていれば送出開始 (割込禁止中に呼ぶ)
+static void HOT_FUNC(ri_kick)(void) {
+    if (g_dma_running || g_fill == 0) {
+        return;
+    }
+    uint8_t b = g_stage;
+    uint    n = g_fill;
+    g_stage ^= 1u;
+    g_fill = 0;
+    g_dma_running = true;
+    dma_channel_transfer_from_buffer_now(g_dma, g_buf[b], n);
 }
 
-static inline void ri_space_us(uint32_t us) {
-    gpio_put(g_ri_gpio, 0);
-    sleep_us(us);
+static void HOT_FUNC(ri_dma_irq)(void) {
+    if (!dma_channel_get_irq0_status(g_dma)) {
+        return;
+    }
+    dma_channel_acknowledge_irq0(g_dma);
+    g_dma_running = false;
+    ri_kick();
 }
 
-static void ri_send_header(void) {
-    ri_mark_us(RI_HEADER_MARK_US);
-    ri_space_us(RI_HEADER_SPACE_US);
+// ワード列を送信列に追加 (積み込みバッファが一杯なら DMA の切り替わりを待つ)
+static void ri_append(const uint32_t *words, uint n) {
+    while (true) {
+        uint32_t save = save_and_disable_interrupts();
+        if (g_fill + n <= RI_TX_BUF_WORDS) {
+            memcpy(&g_buf[g_stage][g_fill], words, n * sizeof(uint32_t));
+            g_fill += n;
+            ri_kick();
+            restore_interrupts(save);
+            return;
+        }
+        restore_interrupts(save);
+
+        stall_enter(STALL_SITE_RI_TX);
+        while (g_dma_running) {
+            tight_loop_contents();
+        }
+        stall_leave();
+    }
 }
 
-static void ri_send_bit(bool one) {
-    ri_mark_us(RI_BIT_MARK_US);
-    ri_space_us(one ? RI_BIT_ONE_SPACE_US : RI_BIT_ZERO_SPACE_US);
+static uint8_t ri_route_of(ri_cmd_t cmd) {
+    switch (cmd) {
+    case RI_CMD_POWER_ON:
+    case RI_CMD_POWER_OFF:
+        return RI_ROUTE_POWER;
+    case RI_CMD_INPUT_SEL:
+        return RI_ROUTE_INPUT;
+    default:
+        return RI_ROUTE_VOLUME;
+    }
 }
 
-static void ri_send_footer(void) {
-    ri_mark_us(RI_FOOTER_MARK_US);
-    ri_space_us(0);
-    sleep_ms(RI_FRAME_GAP_MS);
+// 出力 out の全コマンドをパルス列に展開
+static void ri_prepare(uint out, ri_proto_id_t proto, ri_codeset_id_t set) {
+    const ri_proto_t *p = ri_proto_get(proto);
+    for (int c = 0; c < RI_CMD_COUNT; c++) {
+        uint16_t code = ri_code(set, (ri_cmd_t)c);
+        uint n = 0;
+        if (code != RI_CODE_NONE) {
+            n = ri_proto_encode(p, code, g_pulses[out][c], RI_PROTO_MAX_PULSES);
+            if (n == 0) {
+                panic("RI TX: output %u frame exceeds %u pulses", out, RI_PROTO_MAX_PULSES);
+            }
+        }
+        g_npulses[out][c] = (uint8_t)n;
+    }
 }
 
-void ri_tx_init(uint ri_gpio) {
-    g_ri_gpio = ri_gpio;
+void ri_tx_init(uint ri_gpio, uint count, const uint8_t *routes,
+                const uint8_t *protos, const uint8_t *codesets, bool open_drive) {
+    if (count == 0 || count > RI_TX_MAX_OUTPUTS) {
+        panic("RI TX: invalid output count %u", count);
+    }
+    g_count = count;
+    for (uint i = 0; i < count; i++) {
+        g_routes[i] = routes ? routes[i] : RI_ROUTE_ALL;
+        ri_prepare(i, protos ? (ri_proto_id_t)protos[i] : RI_PROTO_ONKYO,
+                   codesets ? (ri_codeset_id_t)codesets[i] : RI_CODESET_AMP);
+    }
+
+    // PIO / SM / プログラムを確保
+    if (!pio_claim_free_sm_and_add_program_for_gpio_range(
+            open_drive ? &ri_tx_od_program : &ri_tx_program, &g_pio, &g_sm, &g_prog_offset,
+            ri_gpio, count, true)) {
+        panic("RI TX: no free PIO SM");
+    }
+    ri_tx_program_init(g_pio, g_sm, g_prog_offset, ri_gpio, count, open_drive);
+
+    // DMA: バッファ → PIO TX FIFO (DREQ でペーシング)
+    g_dma = (uint)dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(g_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(g_pio, g_sm, true));
+    dma_channel_configure(g_dma, &c, &g_pio->txf[g_sm], NULL, 0, false);
+
+    dma_channel_set_irq0_enabled(g_dma, true);
+    irq_add_shared_handler(DMA_IRQ_0, ri_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+}
 
-    gpio_init(g_ri_gpio);
-    gpio_set_dir(g_ri_gpio, true);
-    gpio_put(g_ri_gpio, 0);
+void ri_tx_clock_changed(void) {
+    // 送出中なら切り替えから更新までの数 µs だけ区間が伸縮する (RI の許容範囲内)
+    pio_sm_set_clkdiv(g_pio, g_sm, ri_tx_clkdiv());
 }
 
-bool ri_tx_send(uint16_t command) {
-    ri_send_header();
+// 出力ごとのパルス列を時間順に走査し、レベルマスク付きの区間ワード列に合成する。
+// 全出力が同じプロトコルならパルス境界が揃うので、ワード数は 1 出力の場合と同じ
+static uint ri_merge(uint8_t out_mask, ri_cmd_t cmd) {
+    uint8_t  idx[RI_TX_MAX_OUTPUTS] = {0};
+    uint32_t rem[RI_TX_MAX_OUTPUTS] = {0};   // 現在のパルスの残り時間
+    uint8_t  live = 0;                       // まだパルスが残っている出力
 
-    uint16_t v = command;
-    for (int i = 0; i < RI_FRAME_BITS; i++) {
-        bool bit = (v & 0x800) != 0;
-        v <<= 1;
-        ri_send_bit(bit);
+    for (uint i = 0; i < g_count; i++) {
+        if ((out_mask & (1u << i)) && g_npulses[i][cmd] > 0) {
+            rem[i] = g_pulses[i][cmd][0];
+            live |= (uint8_t)(1u << i);
+        }
     }
 
-    ri_send_footer();
+    uint n = 0;
+    while (live) {
+        // 次にパルスが切り替わるまでの区間
+        uint32_t seg = UINT32_MAX;
+        uint8_t levels = 0;
+        for (uint i = 0; i < g_count; i++) {
+            if (live & (1u << i)) {
+                if (rem[i] < seg) {
+                    seg = rem[i];
+                }
+                if ((idx[i] & 1u) == 0) {
+                    levels |= (uint8_t)(1u << i);   // 偶数番目 = mark
+                }
+            }
+        }
+
+        // 直前と同じレベルなら延長 (1 つ前の区間を伸ばすだけ)
+        if (n > 0 && (g_words[n - 1] & 0x0Fu) == levels) {
+            g_words[n - 1] += seg << 4;
+        } else {
+            g_words[n++] = ri_word(levels, seg);
+        }
+
+        for (uint i = 0; i < g_count; i++) {
+            if (!(live & (1u << i))) {
+                continue;
+            }
+            rem[i] -= seg;
+            while (rem[i] == 0) {
+                if (++idx[i] >= g_npulses[i][cmd]) {
+                    live &= (uint8_t)~(1u << i);
+                    break;
+                }
+                rem[i] = g_pulses[i][cmd][idx[i]];
+            }
+        }
+    }
+    return n;
+}
+
+bool ri_tx_send_to(uint8_t out_mask, ri_cmd_t cmd) {
+    if (cmd >= RI_CMD_COUNT) {
+        return false;
+    }
+    out_mask &= (uint8_t)((1u << g_count) - 1u);
+    uint n = out_mask ? ri_merge(out_mask, cmd) : 0;
+    if (n == 0) {
+        return false;
+    }
+    ri_append(g_words, n);
     return true;
 }
+
+bool ri_tx_send(ri_cmd_t cmd) {
+    if (cmd >= RI_CMD_COUNT) {
+        return false;
+    }
+    uint8_t route = ri_route_of(cmd);
+    uint8_t mask = 0;
+    for (uint i = 0; i < g_count; i++) {
+        if (g_routes[i] & route) {
+            mask |= (uint8_t)(1u << i);
+        }
+    }
+    return ri_tx_send_to(mask, cmd);
+}
+
+void ri_tx_delay_ms(uint32_t ms) {
+    uint32_t w = ri_word(0, ms * 1000u);
+    ri_append(&w, 1);
+}
+
+bool ri_tx_busy(void) {
+    return g_dma_running || g_fill != 0
+        || !pio_sm_is_tx_fifo_empty(g_pio, g_sm)
+        || pio_sm_get_pc(g_pio, g_sm) != g_prog_offset;
+}
@@ -2,6 +2,38 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "pico/types.h"
+#include "ri_proto.h"
 
-void ri_tx_init(uint ri_gpio);
-bool ri_tx_send(uint16_t command);
+// RI 出力数の上限 (PIO ワードのレベルビット数)
+#define RI_TX_MAX_OUTPUTS 4
+
+// コマンド種別 — 出力ごとのルーティング指定に使う
+#define RI_ROUTE_POWER  0x01  // Power ON / OFF
+#define RI_ROUTE_VOLUME 0x02  // Vol Up / Down, Mute / Unmute
+#define RI_ROUTE_INPUT  0x04  // Input Select
+#define RI_ROUTE_ALL    (RI_ROUTE_POWER | RI_ROUTE_VOLUME | RI_ROUTE_INPUT)
+
+// ri_gpio から連続する count 本の GPIO を RI 出力として初期化。
+// routes[n]   = 出力 n に送るコマンド種別 (RI_ROUTE_*)
+// protos[n]   = 出力 n のプロトコル (ri_proto_id_t、NULL なら全出力 RI_PROTO_ONKYO)
+// codesets[n] = 出力 n のコードセット (ri_codeset_id_t、NULL なら全出力 RI_CODESET_AMP)
+// open_drive = true なら mark だけ駆動し space は解放 (RI RX と同じ線を共有する場合)
+// 全コマンドのパルス列はここで出力ごとに展開しておく
+void ri_tx_init(uint ri_gpio, uint count, const uint8_t *routes,
+                const uint8_t *protos, const uint8_t *codesets, bool open_drive);
+
+// clk_sys 変更後に PIO 分周比を再計算
+void ri_tx_clock_changed(void);
+
+// ルーティングに従って該当する全出力へ同時に送信 (ブロックしない — PIO + DMA が送出)
+bool ri_tx_send(ri_cmd_t cmd);
+
+// 出力マスク (bit n = 出力 n) を指定して送信。
+// 出力ごとにプロトコルが違っても 1 本のワード列に合成して同時に送出する
+bool ri_tx_send_to(uint8_t out_mask, ri_cmd_t cmd);
+
+// 全出力を LOW のまま指定時間待つ区間を送信列に積む (コマンド間のディレイ)
+void ri_tx_delay_ms(uint32_t ms);
+
+// 送信中 (未送出のワードあり) なら true
+bool ri_tx_busy(void);
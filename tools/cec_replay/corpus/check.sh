@@ -0,0 +1,31 @@
+#!/bin/sh
+# コーパスの全キャプチャをリプレイし、期待出力 (*.expected) と比較する
+# *.bist は入力なしで実行するオプション (自己試験のホストシミュレーション)
+#   tools/cec_replay/corpus/check.sh <cec_replay のパス>
+# 期待出力の更新: UPDATE=1 を付けて実行
+set -u
+REPLAY=${1:?usage: check.sh path/to/cec_replay}
+DIR=$(cd "$(dirname "$0")" && pwd)
+fail=0
+for cap in "$DIR"/*.edges "$DIR"/*.csv "$DIR"/*.bist; do
+    [ -e "$cap" ] || continue
+    exp="$cap.expected"
+    [ -e "$exp" ] || [ "${UPDATE:-0}" = 1 ] || continue
+    opts=""
+    input="$cap"
+    [ -e "$cap.opts" ] && opts=$(cat "$cap.opts")
+    case "$cap" in
+        *.bist) opts=$(grep -v "^#" "$cap"); input="" ;;
+    esac
+    if [ "${UPDATE:-0}" = 1 ]; then
+        "$REPLAY" $opts ${input:+"$input"} > "$exp" 2>/dev/null
+        echo "updated $(basename "$exp")"
+    elif "$REPLAY" $opts ${input:+"$input"} 2>/dev/null | diff -u "$exp" - > /dev/null; then
+        echo "ok   $(basename "$exp" .expected)"
+    else
+        echo "FAIL $(basename "$exp" .expected)"
+        "$REPLAY" $opts ${input:+"$input"} 2>/dev/null | diff -u "$exp" - | head -40
+        fail=1
+    fi
+done
+exit $fail
@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""合成キャプチャの生成 (仕様上の公称タイミング + 乱数ジッタ)
+
+実機のキャプチャではない。デコーダ変更時の回帰確認用の基準として使う。
+実 TV のキャプチャは README の手順で追加すること。
+
+    python3 synth.py            # corpus/*.edges / *.csv を再生成
+"""
+import os
+import random
+
+BIT1 = (600, 1800)
+BIT0 = (1500, 900)
+START = (3700, 800)
+ACK_HOLD = 1500        # フォロワーが ACK したときの LOW 幅
+BRIDGE_LA = 5          # ブリッジ宛ては ACK を入れない (リプレイ時にブリッジが ACK する)
+
+
+class Bus:
+    def __init__(self, seed, jitter):
+        self.t = 0
+        self.edges = []          # (t_us, level)
+        self.rng = random.Random(seed)
+        self.jitter = jitter
+
+    def j(self):
+        return self.rng.randint(-self.jitter, self.jitter)
+
+    def sym(self, low, high):
+        self.edges.append((self.t, 0))
+        self.t += low + self.j()
+        self.edges.append((self.t, 1))
+        self.t += high + self.j()
+
+    def idle(self, us):
+        self.t += us
+
+    def glitch(self, us):
+        self.edges.append((self.t, 0))
+        self.edges.append((self.t + us, 1))
+        self.t += us
+
+    def frame(self, data, acked_by_follower=None):
+        dst = data[0] & 0x0F
+        if acked_by_follower is None:
+            acked_by_follower = dst not in (0x0F, BRIDGE_LA)
+        self.sym(*START)
+        for i, b in enumerate(data):
+            for k in range(7, -1, -1):
+                self.sym(*(BIT1 if (b >> k) & 1 else BIT0))
+            self.sym(*(BIT1 if i == len(data) - 1 else BIT0))          # EOM
+            if acked_by_follower:
+                self.sym(ACK_HOLD, 2400 - ACK_HOLD)
+            else:
+                self.sym(*BIT1)
+        self.idle(12000)
+
+
+def session():
+    """TV (0) が Audio System (5) を使い始める典型的な流れ"""
+    b = Bus(seed=1, jitter=40)
+    b.idle(5000)
+    b.frame([0x05])                               # polling
+    b.frame([0x05, 0x8F])                         # Give Device Power Status
+    b.frame([0x05, 0x70, 0x10, 0x00])             # System Audio Mode Request (ON)
+    b.frame([0x05, 0x71])                         # Give Audio Status
+    b.frame([0x05, 0x44, 0x41])                   # UCP Volume Up
+    b.frame([0x05, 0x44, 0x41])                   # 同じ UCP の再送 (TV が ACK を取りこぼした想定)
+    b.frame([0x05, 0x45])                         # UCP Released
+    b.frame([0x05, 0x73, 0x28])                   # Set Audio Volume Level 40
+    b.idle(800000)
+    b.frame([0x04, 0x8F])                         # TV -> Playback 1 (ACK by 4)
+    b.frame([0x40, 0x90, 0x00])                   # Report Power Status
+    b.glitch(80)                                  # ノイズ
+    b.idle(3000)
+    b.frame([0x05, 0xC0])                         # 未対応 opcode -> Feature Abort
+    b.frame([0x0F, 0x36])                         # Standby (broadcast)
+    return b.edges
+
+
+def write_edges(path, edges):
+    with open(path, "w") as f:
+        f.write("# synthetic capture (nominal timing +-40 us jitter), time_us level\n")
+        for t, lvl in edges:
+            f.write(f"{t} {lvl}\n")
+
+
+def write_csv(path, edges):
+    with open(path, "w") as f:
+        f.write("Time [s],Channel 0\n")
+        f.write("0.000000000,1\n")
+        for t, lvl in edges:
+            f.write(f"{(t + 1000) / 1e6:.9f},{lvl}\n")
+
+
+if __name__ == "__main__":
+    here = os.path.dirname(os.path.abspath(__file__))
+    e = session()
+    write_edges(os.path.join(here, "synthetic_session.edges"), e)
+    write_csv(os.path.join(here, "synthetic_session.csv"), e)
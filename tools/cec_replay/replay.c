@@ -0,0 +1,334 @@
+// cec_replay — キャプチャしたエッジ列をファームウェアの CEC RX デコーダと
+// フレームハンドラ (bridge) にそのまま通し、復号フレーム・アクション・タイミング異常を出力する。
+//
+// 入力 (ファイルまたは標準入力):
+//   - ロジックアナライザの CSV (Saleae 等): "Time [s],Channel 0" のヘッダ + 時刻,レベル
+//   - エッジリスト: "時刻 レベル" (区切りは空白 / カンマ / タブ)
+//   - 時刻のみの 1 列: 各行が 1 エッジ (HIGH から始まり交互に反転)
+// '#' / ';' で始まる行はコメント。
+//
+// -b は入力を読まず、ファームウェアの自己試験 (cec_bist) を shim の送信波形に対して実行する。
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include "replay.h"
+#include "cec/cec_od.h"
+#include "cec/cec_rx.h"
+#include "cec/cec_cal.h"
+#include "cec/cec_stats.h"
+#include "cec/cec_topo.h"
+#include "cec/cec_bist.h"
+#include "bridge/bridge.h"
+
+#define REPLAY_START_US    1000000  // 最初のエッジを置く仮想時刻 (0 は nil time なので避ける)
+#define REPLAY_SERVICE_US  1000     // 音量ランプ中の bridge_service 呼び出し間隔
+#define REPLAY_DRAIN_US    10000000 // 入力終了後に音量ランプを流し切る上限
+#define REPLAY_HIGH_MIN_US 300      // これより短い HIGH はグリッチ扱い
+
+typedef enum { UNIT_AUTO, UNIT_S, UNIT_MS, UNIT_US } unit_t;
+
+typedef struct {
+    uint64_t edges;
+    uint64_t frames;
+    uint64_t anomalies;
+    uint64_t skipped;     // 解釈できない行 / 時刻の逆行
+} replay_stats_t;
+
+static replay_stats_t g_stats;
+static uint64_t       g_next_service = UINT64_MAX;
+static bool           g_verbose_anomalies = true;
+
+// -b: 自己試験の結果
+static bool g_bist_pass;
+
+static void bist_done(bool pass) {
+    g_bist_pass = pass;
+}
+
+static double ms_of(uint64_t us) {
+    return (double)(us - REPLAY_START_US) / 1000.0;
+}
+
+// ---- 実行 ----
+
+// ISR にエッジを届け、復号できたフレームをハンドラへ渡す
+static void settle_and_poll(void) {
+    shim_bus_settle();
+
+    cec_frame_t f;
+    while (cec_rx_poll_frame(CEC_BUS_MAIN, &f)) {
+        g_stats.frames++;
+        printf("@ %.3f ms\n", ms_of(shim_now_us));
+        bridge_handle_frame(&f);
+        if (bridge_busy() && g_next_service == UINT64_MAX) {
+            g_next_service = shim_now_us;
+        }
+    }
+}
+
+// 仮想時刻を t まで進める (途中のアラームとランプ処理を時刻順に実行)
+static void advance_to(uint64_t t) {
+    for (;;) {
+        uint64_t alarm = shim_next_alarm();
+        uint64_t next = alarm < g_next_service ? alarm : g_next_service;
+        if (next > t) {
+            break;
+        }
+        if (next == alarm) {
+            shim_fire_alarm();
+        } else {
+            shim_now_us = next;
+            bridge_service();
+            g_next_service = bridge_busy() ? next + REPLAY_SERVICE_US : UINT64_MAX;
+        }
+        settle_and_poll();
+    }
+    shim_now_us = t;
+}
+
+// ---- タイミング異常 (キャプチャ側の波形を既定の判定窓で検査) ----
+
+static void anomaly(const char *what, uint64_t t, uint64_t width) {
+    g_stats.anomalies++;
+    if (g_verbose_anomalies) {
+        printf("!! %.3f ms: %s %llu us\n", ms_of(t), what, (unsigned long long)width);
+    }
+}
+
+static void check_edge(uint64_t t, bool level, uint64_t last_t, bool have_last) {
+    if (!have_last) {
+        return;
+    }
+    uint64_t w = t - last_t;
+    const cec_cal_win_t *win = cec_cal_window(CEC_CAL_NO_LA);
+    if (level) {
+        // LOW 幅: bit1 / bit0 / start のいずれか、または ACK スロットの引き延ばし (bit1 と bit0 の間)
+        bool ok = (w >= win->bit1_min && w <= win->bit0_max)
+               || (w >= win->start_min && w <= win->start_max);
+        if (!ok) {
+            anomaly("LOW outside symbol windows", last_t, w);
+        }
+    } else if (w < REPLAY_HIGH_MIN_US) {
+        anomaly("short HIGH", last_t, w);
+    }
+}
+
+// ---- 入力 ----
+
+static unit_t unit_from_header(const char *line) {
+    if (strstr(line, "[us]") || strstr(line, "(us)") || strstr(line, "\xC2\xB5s")) return UNIT_US;
+    if (strstr(line, "[ms]") || strstr(line, "(ms)")) return UNIT_MS;
+    if (strstr(line, "[s]") || strstr(line, "(s)")) return UNIT_S;
+    return UNIT_AUTO;
+}
+
+static bool is_header(const char *line) {
+    for (const char *p = line; *p; p++) {
+        if (isalpha((unsigned char)*p) && *p != 'e' && *p != 'E') {
+            return true;
+        }
+    }
+    return false;
+}
+
+// フィールドを分割 (空白 / カンマ / タブ)。戻り値はフィールド数
+static int split(char *line, char **fields, int max) {
+    int n = 0;
+    char *p = line;
+    while (*p && n < max) {
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        if (!*p || *p == '\n' || *p == '\r') break;
+        fields[n++] = p;
+        while (*p && *p != ' ' && *p != '\t' && *p != ',' && *p != '\n' && *p != '\r') p++;
+        if (*p) *p++ = '\0';
+    }
+    return n;
+}
+
+static void usage(void) {
+    fprintf(stderr,
+            "usage: cec_replay [-q] [-n] [-s] [-u s|ms|us] [-c column] [capture.csv|-]\n"
+            "       cec_replay -b [-d ppm] [-j us]\n"
+            "  -q  summary only (no frames / actions / anomalies)\n"
+            "  -s  print bus statistics (cec_stats) at the end\n"
+            "  -n  do not ACK (capture already contains this bridge's ACK bits)\n"
+            "  -u  timestamp unit (default: from CSV header, else s if fractional, else us)\n"
+            "  -c  level column (default 1; time is column 0)\n"
+            "  -b  run the timing self-test (cec_bist) against the simulated transmitter\n"
+            "  -d  simulated TX clock error in ppm (with -b)\n"
+            "  -j  simulated TX jitter, +/- us per segment (with -b)\n");
+}
+
+int main(int argc, char **argv) {
+    unit_t unit = UNIT_AUTO;
+    int col = 1;
+    bool quiet = false;
+    bool ack = true;
+    bool stats = false;
+    bool bist = false;
+    const char *path = "-";
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-q")) {
+            quiet = true;
+        } else if (!strcmp(argv[i], "-s")) {
+            stats = true;
+        } else if (!strcmp(argv[i], "-n")) {
+            ack = false;
+        } else if (!strcmp(argv[i], "-b")) {
+            bist = true;
+        } else if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+            shim_tx_drift_ppm = (int32_t)atol(argv[++i]);
+        } else if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+            shim_tx_jitter_us = (uint32_t)atol(argv[++i]);
+        } else if (!strcmp(argv[i], "-u") && i + 1 < argc) {
+            const char *u = argv[++i];
+            unit = !strcmp(u, "s") ? UNIT_S : !strcmp(u, "ms") ? UNIT_MS : !strcmp(u, "us") ? UNIT_US : UNIT_AUTO;
+        } else if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+            col = atoi(argv[++i]);
+        } else if (argv[i][0] == '-' && argv[i][1]) {
+            usage();
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    if (bist) {
+        shim_now_us = REPLAY_START_US;
+        cec_od_init(CEC_BUS_MAIN, 0);
+        cec_rx_init(CEC_BUS_MAIN, 0);
+        cec_rx_set_logical_addr(CEC_BUS_MAIN, BRIDGE_LA);
+        cec_rx_enable_ack(CEC_BUS_MAIN, true);
+        cec_bist_start(BRIDGE_LA, bist_done);
+        while (cec_bist_busy()) {
+            sleep_ms(1);
+            cec_bist_service();
+        }
+        return g_bist_pass ? 0 : 1;
+    }
+
+    FILE *in = strcmp(path, "-") ? fopen(path, "r") : stdin;
+    if (!in) {
+        perror(path);
+        return 1;
+    }
+    static char inbuf[1 << 20];
+    setvbuf(in, inbuf, _IOFBF, sizeof inbuf);
+    if (quiet) {
+        g_verbose_anomalies = false;
+        if (!freopen("/dev/null", "w", stdout)) {
+            return 1;
+        }
+    } else {
+        static char outbuf[1 << 16];
+        setvbuf(stdout, outbuf, _IOFBF, sizeof outbuf);
+    }
+
+    // ファームウェアと同じ初期化順
+    shim_now_us = REPLAY_START_US;
+    shim_feedback = ack;
+    cec_od_init(CEC_BUS_MAIN, 0);
+    cec_rx_init(CEC_BUS_MAIN, 0);
+    cec_rx_set_logical_addr(CEC_BUS_MAIN, BRIDGE_LA);
+    cec_rx_enable_ack(CEC_BUS_MAIN, ack);
+    cec_topo_init(BRIDGE_LA);
+
+    clock_t c0 = clock();
+    char line[512];
+    bool first = true;
+    bool toggle = false;
+    bool level = true;
+    double base = 0.0;
+    double scale = 1.0;
+    uint64_t last_t = REPLAY_START_US;
+    bool have_last = false;
+
+    while (fgets(line, sizeof line, in)) {
+        if (line[0] == '#' || line[0] == ';' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+        if (first && is_header(line)) {
+            if (unit == UNIT_AUTO) {
+                unit = unit_from_header(line);
+            }
+            continue;
+        }
+
+        char *fields[8];
+        int n = split(line, fields, 8);
+        if (n == 0) {
+            continue;
+        }
+        if (first) {
+            toggle = (n == 1);
+            if (unit == UNIT_AUTO) {
+                unit = strpbrk(fields[0], ".eE") ? UNIT_S : UNIT_US;
+            }
+            scale = unit == UNIT_S ? 1e6 : unit == UNIT_MS ? 1e3 : 1.0;
+            base = strtod(fields[0], NULL);
+            first = false;
+        }
+
+        double v = strtod(fields[0], NULL);
+        uint64_t t = REPLAY_START_US + (uint64_t)llround((v - base) * scale);
+        bool next;
+        if (toggle) {
+            next = !level;
+        } else if (col < n) {
+            next = strtol(fields[col], NULL, 10) != 0;
+        } else {
+            g_stats.skipped++;
+            continue;
+        }
+        if (have_last && t < last_t) {
+            g_stats.skipped++;
+            continue;
+        }
+        if (next == level) {
+            continue;  // サンプル形式の CSV は同じレベルが続く
+        }
+
+        g_stats.edges++;
+        check_edge(t, next, last_t, have_last);
+        advance_to(t);
+        shim_bus_capture(next);
+        settle_and_poll();
+        level = next;
+        last_t = t;
+        have_last = true;
+    }
+
+    // 入力終了後: 残りのアラームと音量ランプを流し切る (仮想時刻は最後のイベントまで)
+    uint64_t end = shim_now_us + REPLAY_DRAIN_US;
+    for (;;) {
+        uint64_t alarm = shim_next_alarm();
+        uint64_t next = alarm < g_next_service ? alarm : g_next_service;
+        if (next > end) {
+            break;
+        }
+        advance_to(next);
+    }
+    if (in != stdin) {
+        fclose(in);
+    }
+
+    double cpu = (double)(clock() - c0) / CLOCKS_PER_SEC;
+    if (stats) {
+        cec_stats_dump();
+    }
+    fflush(stdout);
+    fprintf(stderr, "cec_replay: %llu edges, %llu frames, %llu anomalies, %lu ACKs, %lu CEC TX, %lu RI, %llu skipped lines\n",
+            (unsigned long long)g_stats.edges, (unsigned long long)g_stats.frames,
+            (unsigned long long)g_stats.anomalies, (unsigned long)shim_stats.acks,
+            (unsigned long)shim_stats.cec_tx, (unsigned long)shim_stats.ri_tx,
+            (unsigned long long)g_stats.skipped);
+    fprintf(stderr, "cec_replay: %.3f s of bus time in %.3f s CPU (%.2f M edges/s)\n",
+            have_last ? (double)(last_t - REPLAY_START_US) / 1e6 : 0.0, cpu,
+            cpu > 0 ? (double)g_stats.edges / cpu / 1e6 : 0.0);
+    return 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "pico_shim.h"
+
+// リプレイ用のバスモデルと出力カウンタ (shim.c)
+// バスのレベル = キャプチャのレベル AND (自分が ACK で引き下げていない)。
+// ISR から cec_od_drive_low(bus) されると、ISR を抜けたあとの shim_bus_settle() で
+// 立ち下がりエッジとして ISR に再投入される (実機の GPIO 割り込みと同じ順序)。
+
+typedef struct {
+    uint32_t isr_calls;
+    uint32_t acks;       // ACK 引き下げ回数
+    uint32_t cec_tx;     // 送信キューに積まれたフレーム数
+    uint32_t ri_tx;      // RI コマンド数
+} shim_stats_t;
+
+extern shim_stats_t shim_stats;
+extern bool         shim_feedback;  // false なら ACK の引き下げをバスに反映しない
+
+// cec_tx_send_bytes の送信波形 (自己試験のホストシミュレーション用)
+extern int32_t shim_tx_drift_ppm;   // 送信側クロックの誤差 (全区間を伸縮)
+extern uint32_t shim_tx_jitter_us;  // 区間ごとに加える ±ジッタの最大値
+
+// キャプチャ側のレベルを変更 (shim_now_us 時点)
+void shim_bus_capture(bool level);
+// バスのレベル変化を ISR に届ける (変化がなくなるまで)
+void shim_bus_settle(void);
+
+// 次のアラーム時刻 (なければ UINT64_MAX) と、その発火
+uint64_t shim_next_alarm(void);
+void     shim_fire_alarm(void);
@@ -0,0 +1,189 @@
+// RI 送信波形のホスト試験
+// ファームウェアの src/ri/ri_proto.c (パルス列展開) と src/ri/ri_tx.c (出力合成) をそのまま使い、
+// ri_proto_encode() のパルス列と ri_tx_send_to() が DMA に渡すワード列を手書きの参照値と比較する。
+// RI_PROTO_CUSTOM / RI_CODESET_CUSTOM は CMakeLists.txt で試験用の 16 bit 機種を定義している。
+//   build-replay/ri_wave     (終了コード: 全件一致なら 0)
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/irq.h"
+#include "ri/ri_tx.h"
+#include "diag/stall.h"
+
+// ---- shim ----
+
+pio_hw_t      shim_pio0;
+irq_handler_t shim_dma_irq;
+
+#define CAPTURE_MAX 512
+static uint32_t g_cap[CAPTURE_MAX];
+static uint     g_ncap;
+
+void shim_dma_transfer(const uint32_t *words, uint n) {
+    for (uint i = 0; i < n && g_ncap < CAPTURE_MAX; i++) {
+        g_cap[g_ncap++] = words[i];
+    }
+}
+
+void panic(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    exit(2);
+}
+
+void stall_enter(stall_site_t site) { (void)site; }
+void stall_leave(void) {}
+
+// ---- 参照値 ----
+
+// ONKYO 12 bit, Power ON (0x1AF = 0001 1010 1111)
+static const uint16_t k_onkyo_power_on[] = {
+    3000, 1000,
+    1000, 1000, 1000, 1000, 1000, 1000, 1000, 2000,
+    1000, 2000, 1000, 1000, 1000, 2000, 1000, 1000,
+    1000, 2000, 1000, 2000, 1000, 2000, 1000, 2000,
+    1000, 20000,
+};
+
+// CUSTOM 16 bit (CMakeLists.txt の RI_CUSTOM_PROTO), Power ON (0xD20F = 1101 0010 0000 1111)
+static const uint16_t k_custom_power_on[] = {
+    2400, 600,
+    600, 1200, 600, 1200, 600, 600, 600, 1200,
+    600, 600, 600, 600, 600, 1200, 600, 600,
+    600, 600, 600, 600, 600, 600, 600, 600,
+    600, 1200, 600, 1200, 600, 1200, 600, 1200,
+    600, 12000,
+};
+
+typedef struct {
+    uint8_t  levels;
+    uint32_t us;
+} seg_t;
+
+// 出力 0 = ONKYO, 出力 1 = CUSTOM で Power ON を同時送信したときの区間列。
+// 2 本のパルス列を 1 µs ごとに標本化してレベルマスクをランレングス化したもの
+static const seg_t k_mixed_power_on[] = {
+    { 3,  2400 }, { 1,   600 }, { 2,   600 }, { 0,   400 }, { 1,   800 }, { 3,   200 },
+    { 2,   400 }, { 0,   600 }, { 1,   600 }, { 3,   400 }, { 2,   200 }, { 0,   600 },
+    { 2,   200 }, { 3,   400 }, { 1,   600 }, { 0,   600 }, { 2,   400 }, { 3,   200 },
+    { 1,   600 }, { 3,   200 }, { 2,   400 }, { 0,   600 }, { 2,   600 }, { 0,   400 },
+    { 1,   800 }, { 3,   200 }, { 2,   400 }, { 0,   600 }, { 2,   600 }, { 0,   400 },
+    { 1,   200 }, { 3,   600 }, { 1,   200 }, { 0,   400 }, { 2,   600 }, { 1,   600 },
+    { 3,   400 }, { 2,   200 }, { 0,   600 }, { 2,   600 }, { 0,   600 }, { 1,   600 },
+    { 3,   400 }, { 2,   200 }, { 0,   800 }, { 1,   400 }, { 3,   600 }, { 0,  1200 },
+    { 2,   600 }, { 0,   200 }, { 1,  1000 }, { 2,   600 }, { 0,  1400 }, { 1,  1000 },
+    { 0,  2000 }, { 1,  1000 }, { 0,  2000 }, { 1,  1000 }, { 0, 20000 },
+};
+
+#define COUNT_OF(a) (sizeof(a) / sizeof((a)[0]))
+
+// ---- 比較 ----
+
+static uint g_fail;
+
+static void result(const char *name, bool ok) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", name);
+    if (!ok) {
+        g_fail++;
+    }
+}
+
+static bool same_pulses(const uint16_t *got, uint n, const uint16_t *exp, uint nexp) {
+    bool ok = (n == nexp);
+    for (uint i = 0; i < n || i < nexp; i++) {
+        uint g = i < n ? got[i] : 0;
+        uint e = i < nexp ? exp[i] : 0;
+        if (g != e) {
+            printf("  [%u] got %u expected %u\n", i, g, e);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static void check_encode(const char *name, ri_proto_id_t proto, ri_codeset_id_t set,
+                         const uint16_t *exp, uint nexp) {
+    uint16_t us[RI_PROTO_MAX_PULSES];
+    uint n = ri_proto_encode(ri_proto_get(proto), ri_code(set, RI_CMD_POWER_ON), us, RI_PROTO_MAX_PULSES);
+    result(name, same_pulses(us, n, exp, nexp));
+}
+
+// 送出ワード列 (レベル + X = us - 4) を参照区間列と比較
+static bool same_words(const seg_t *exp, uint nexp) {
+    bool ok = (g_ncap == nexp);
+    for (uint i = 0; i < g_ncap || i < nexp; i++) {
+        uint32_t e = i < nexp ? (((exp[i].us - 4u) << 4) | exp[i].levels) : 0;
+        uint32_t g = i < g_ncap ? g_cap[i] : 0;
+        if (g != e) {
+            printf("  [%u] got levels=%X %lu us, expected levels=%X %lu us\n", i,
+                   (unsigned)(g & 0x0Fu), (unsigned long)(g >> 4) + 4u,
+                   (unsigned)(e & 0x0Fu), (unsigned long)(e >> 4) + 4u);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// パルス列 (mark から交互) → levels の区間列
+static uint pulses_to_segs(const uint16_t *us, uint n, uint8_t levels, seg_t *out) {
+    for (uint i = 0; i < n; i++) {
+        out[i].levels = (i & 1u) ? 0 : levels;
+        out[i].us     = us[i];
+    }
+    return n;
+}
+
+static void check_merge(const char *name, uint count, const uint8_t *protos, const uint8_t *codesets,
+                        uint8_t mask, const seg_t *exp, uint nexp) {
+    ri_tx_init(0, count, NULL, protos, codesets, false);
+    g_ncap = 0;
+    bool sent = ri_tx_send_to(mask, RI_CMD_POWER_ON);
+    if (shim_dma_irq) {
+        shim_dma_irq();   // 転送完了
+    }
+    result(name, sent && same_words(exp, nexp));
+}
+
+int main(void) {
+    seg_t segs[RI_PROTO_MAX_PULSES];
+
+    // ri_proto_encode()
+    check_encode("encode ONKYO / AMP Power ON", RI_PROTO_ONKYO, RI_CODESET_AMP,
+                 k_onkyo_power_on, COUNT_OF(k_onkyo_power_on));
+    check_encode("encode CUSTOM / CUSTOM Power ON", RI_PROTO_CUSTOM, RI_CODESET_CUSTOM,
+                 k_custom_power_on, COUNT_OF(k_custom_power_on));
+
+    ri_proto_t big = *ri_proto_get(RI_PROTO_CUSTOM);
+    big.repeat = 2;   // 2 × 36 パルス > RI_PROTO_MAX_PULSES
+    uint16_t us[RI_PROTO_MAX_PULSES];
+    result("encode overflow returns 0", ri_proto_encode(&big, 0xD20F, us, RI_PROTO_MAX_PULSES) == 0);
+
+    // ri_merge() (ri_tx_send_to() が DMA に渡すワード列)
+    const uint8_t onkyo[]  = { RI_PROTO_ONKYO, RI_PROTO_ONKYO };
+    const uint8_t amp[]    = { RI_CODESET_AMP, RI_CODESET_AMP };
+    const uint8_t mixed[]  = { RI_PROTO_ONKYO, RI_PROTO_CUSTOM };
+    const uint8_t mixset[] = { RI_CODESET_AMP, RI_CODESET_CUSTOM };
+
+    uint n = pulses_to_segs(k_onkyo_power_on, COUNT_OF(k_onkyo_power_on), 0x1, segs);
+    check_merge("merge 1 output ONKYO", 1, onkyo, amp, 0x1, segs, n);
+
+    n = pulses_to_segs(k_custom_power_on, COUNT_OF(k_custom_power_on), 0x1, segs);
+    check_merge("merge 1 output CUSTOM", 1, mixed + 1, mixset + 1, 0x1, segs, n);
+
+    n = pulses_to_segs(k_onkyo_power_on, COUNT_OF(k_onkyo_power_on), 0x3, segs);
+    check_merge("merge 2 outputs same protocol", 2, onkyo, amp, 0x3, segs, n);
+
+    n = pulses_to_segs(k_custom_power_on, COUNT_OF(k_custom_power_on), 0x2, segs);
+    check_merge("merge 2 outputs, mask = output 1 only", 2, mixed, mixset, 0x2, segs, n);
+
+    check_merge("merge 2 outputs ONKYO + CUSTOM", 2, mixed, mixset, 0x3,
+                k_mixed_power_on, COUNT_OF(k_mixed_power_on));
+
+    printf("%s: %u failed\n", g_fail ? "FAIL" : "PASS", g_fail);
+    return g_fail ? 1 : 0;
+}
@@ -0,0 +1,269 @@
+#include "replay.h"
+#include <string.h>
+#include "cec/cec_od.h"
+#include "cec/cec_rx.h"
+#include "cec/cec_tx.h"
+#include "cec/cec_txq.h"
+#include "cec/cec_la.h"
+#include "cec/cec_timing.h"
+#include "ri/ri_tx.h"
+#include "led/led.h"
+#include "diag/stall.h"
+
+// ホスト用のハードウェア代替
+// 仮想時刻・アラーム・GPIO 割り込みと、送信系モジュール (cec_txq / ri_tx / led / stall) のスタブ。
+// 送信系は実行する代わりにアクション行 ("  >> ...") を出力する。
+// cec_tx_send_bytes だけは PIO の代わりに波形をバスモデルへ出し、ループバックを RX に復号させる。
+
+uint64_t      shim_now_us = 0;
+io_bank0_hw_t shim_io_bank0;
+shim_stats_t  shim_stats;
+bool          shim_feedback = true;
+int32_t       shim_tx_drift_ppm = 0;
+uint32_t      shim_tx_jitter_us = 0;
+
+// ---- アラーム ----
+
+#define SHIM_MAX_ALARMS 8
+
+typedef struct {
+    alarm_id_t       id;     // 0 = 空き
+    uint64_t         at_us;
+    alarm_callback_t cb;
+    void            *user_data;
+} shim_alarm_t;
+
+static shim_alarm_t s_alarms[SHIM_MAX_ALARMS];
+static alarm_id_t   s_next_id = 1;
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t cb, void *user_data, bool fire_if_past) {
+    (void)fire_if_past;
+    for (int i = 0; i < SHIM_MAX_ALARMS; i++) {
+        if (s_alarms[i].id == 0) {
+            s_alarms[i] = (shim_alarm_t){ s_next_id++, shim_now_us + us, cb, user_data };
+            return s_alarms[i].id;
+        }
+    }
+    return -1;
+}
+
+bool cancel_alarm(alarm_id_t id) {
+    for (int i = 0; i < SHIM_MAX_ALARMS; i++) {
+        if (s_alarms[i].id == id) {
+            s_alarms[i].id = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int next_alarm_index(void) {
+    int best = -1;
+    for (int i = 0; i < SHIM_MAX_ALARMS; i++) {
+        if (s_alarms[i].id != 0 && (best < 0 || s_alarms[i].at_us < s_alarms[best].at_us)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+uint64_t shim_next_alarm(void) {
+    int i = next_alarm_index();
+    return i < 0 ? UINT64_MAX : s_alarms[i].at_us;
+}
+
+void shim_fire_alarm(void) {
+    int i = next_alarm_index();
+    if (i < 0) {
+        return;
+    }
+    shim_alarm_t a = s_alarms[i];
+    s_alarms[i].id = 0;
+    shim_now_us = a.at_us;
+    int64_t r = a.cb(a.id, a.user_data);
+    if (r != 0) {
+        // 再スケジュール (正: 前回予定時刻から / 負: 現在時刻から)
+        s_alarms[i] = a;
+        s_alarms[i].at_us = r > 0 ? a.at_us + (uint64_t)r : shim_now_us + (uint64_t)-r;
+    }
+}
+
+// ---- GPIO / バスモデル ----
+
+static gpio_irq_callback_t s_irq_cb;
+static uint s_gpio;
+static bool s_capture = true;   // キャプチャ上のレベル
+static bool s_drive = false;    // 自分が LOW に引いているか
+static bool s_seen = true;      // ISR に届けた最後のレベル
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback) {
+    (void)event_mask;
+    s_gpio = gpio;
+    s_irq_cb = enabled ? callback : NULL;
+}
+
+static bool bus_level(void) {
+    return s_capture && !(s_drive && shim_feedback);
+}
+
+void shim_bus_capture(bool level) {
+    s_capture = level;
+}
+
+void shim_bus_settle(void) {
+    while (s_irq_cb && bus_level() != s_seen) {
+        s_seen = bus_level();
+        shim_stats.isr_calls++;
+        s_irq_cb(s_gpio, s_seen ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL);
+    }
+}
+
+// ---- 仮想時刻 ----
+
+static void run_until(uint64_t t) {
+    while (shim_next_alarm() <= t) {
+        shim_fire_alarm();
+        shim_bus_settle();
+    }
+    shim_now_us = t;
+    shim_bus_settle();
+}
+
+void sleep_us(uint64_t us) {
+    run_until(shim_now_us + us);
+}
+
+void sleep_ms(uint32_t ms) {
+    run_until(shim_now_us + (uint64_t)ms * 1000u);
+}
+
+// ---- cec_tx (公称タイミング + 誤差 / ジッタで波形を生成) ----
+
+#define SHIM_ACK_SAMPLE_US 1050
+
+static uint32_t s_jitter_seed = 1;
+
+static uint64_t tx_width(uint32_t us) {
+    int64_t w = (int64_t)us + (int64_t)us * shim_tx_drift_ppm / 1000000;
+    if (shim_tx_jitter_us) {
+        s_jitter_seed = s_jitter_seed * 1103515245u + 12345u;
+        w += (int64_t)((s_jitter_seed >> 16) % (2u * shim_tx_jitter_us + 1u)) - (int64_t)shim_tx_jitter_us;
+    }
+    return w > 0 ? (uint64_t)w : 1u;
+}
+
+// 1 シンボル送出。ACK スロットならサンプル点のバスレベルを返す
+static bool tx_symbol(uint32_t low_us, uint32_t high_us) {
+    uint64_t t0 = shim_now_us;
+    uint64_t low = tx_width(low_us);
+    uint64_t high = tx_width(high_us);
+
+    shim_bus_capture(false);
+    shim_bus_settle();
+    run_until(t0 + low);
+    shim_bus_capture(true);
+    shim_bus_settle();
+    if (t0 + SHIM_ACK_SAMPLE_US > shim_now_us) {
+        run_until(t0 + SHIM_ACK_SAMPLE_US);
+    }
+    bool level = cec_od_read(CEC_BUS_MAIN);
+    run_until(t0 + low + high);
+    return level;
+}
+
+cec_tx_result_t cec_tx_send_bytes(uint bus, const uint8_t *bytes, size_t len, const uint32_t *words) {
+    (void)words;   // 波形は bytes から直接出す
+    if (!bytes || len == 0 || len > CEC_MAX_FRAME_BYTES || !cec_od_read(bus)) {
+        return CEC_TX_NOT_SENT;
+    }
+    bool broadcast = (bytes[0] & 0x0F) == 0x0F;
+    bool success = true;
+    size_t sent = 0;
+
+    cec_rx_loopback_begin(bus);
+    tx_symbol(CEC_T_START_LOW, CEC_T_START_HIGH);
+    for (size_t i = 0; i < len && success; i++) {
+        for (int bit = 7; bit >= 0; bit--) {
+            bool one = (bytes[i] >> bit) & 1u;
+            tx_symbol(one ? CEC_T_BIT1_LOW : CEC_T_BIT0_LOW, one ? CEC_T_BIT1_HIGH : CEC_T_BIT0_HIGH);
+        }
+        bool eom = i == len - 1;
+        tx_symbol(eom ? CEC_T_BIT1_LOW : CEC_T_BIT0_LOW, eom ? CEC_T_BIT1_HIGH : CEC_T_BIT0_HIGH);
+        bool bus_high = tx_symbol(CEC_T_BIT1_LOW, CEC_T_BIT1_HIGH);
+        success = broadcast ? bus_high : !bus_high;
+        sent++;
+    }
+
+    uint8_t lb[CEC_MAX_FRAME_BYTES];
+    uint8_t lb_len = cec_rx_loopback_end(bus, lb, sizeof lb);
+    if (lb_len < sent || memcmp(lb, bytes, sent) != 0) {
+        return CEC_TX_NOT_SENT;
+    }
+    return success ? CEC_TX_OK : CEC_TX_NACK;
+}
+
+// ---- cec_od (バスモデルは 1 本なので bus は無視) ----
+
+void cec_od_init(uint bus, uint gpio) {
+    (void)bus;
+    s_gpio = gpio;
+}
+
+void cec_od_drive_low(uint bus) {
+    (void)bus;
+    s_drive = true;
+    shim_stats.acks++;
+}
+
+void cec_od_release(uint bus) {
+    (void)bus;
+    s_drive = false;
+}
+
+bool cec_od_read(uint bus) {
+    (void)bus;
+    return bus_level();
+}
+
+uint cec_od_gpio(uint bus) {
+    (void)bus;
+    return s_gpio;
+}
+
+// ---- cec_txq (送信せずにアクションとして出力) ----
+
+bool cec_txq_push(const uint8_t *bytes, size_t len, cec_txq_prio_t prio, const char *tag) {
+    shim_stats.cec_tx++;
+    printf("  >> CEC TX [%s] %s:", prio == CEC_TXQ_PRIO_REPLY ? "reply" : "broadcast", tag);
+    for (size_t i = 0; i < len; i++) {
+        printf(" %02X", bytes[i]);
+    }
+    printf("\n");
+    return true;
+}
+
+// ---- cec_la (リプレイは論理アドレスを確保済みの状態で動かす) ----
+
+bool cec_la_claimed(void) {
+    return true;
+}
+
+// ---- ri_tx (出力ルーティングと波形合成は ri_tx.c 側の処理なので扱わない) ----
+// コードは出力 0 の既定コードセットで表示する
+
+bool ri_tx_send(ri_cmd_t cmd) {
+    shim_stats.ri_tx++;
+    printf("  >> RI %s (0x%03X)\n", ri_cmd_name(cmd), (unsigned)ri_code(RI_CODESET_AMP, cmd));
+    return true;
+}
+
+void ri_tx_delay_ms(uint32_t ms) {
+    printf("  >> RI delay %lu ms\n", (unsigned long)ms);
+}
+
+// ---- led / stall ----
+
+void led_flash(led_ch_t ch) { (void)ch; }
+
+void stall_enter(stall_site_t site) { (void)site; }
+void stall_leave(void) {}
@@ -0,0 +1,11 @@
+#pragma once
+// tx_bench 用: pioasm が生成する cec_tx.pio.h の代替 (プログラム本体は不要)
+#include "hardware/pio.h"
+
+static const pio_program_t cec_tx_program = { NULL, 7 };
+
+static inline float cec_tx_clkdiv(void) { return 1.0f; }
+
+static inline void cec_tx_program_init(PIO pio, uint sm, uint offset, uint gpio) {
+    (void)pio; (void)sm; (void)offset; (void)gpio;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "../pico_shim.h"
+
+// ri_wave 用: 転送開始で送出ワード列を記録する (shim_dma_transfer は ri_wave.c)
+typedef struct {
+    uint32_t ctrl;
+} dma_channel_config;
+
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 };
+
+void shim_dma_transfer(const uint32_t *words, uint n);
+
+static inline int dma_claim_unused_channel(bool required) { (void)required; return 0; }
+static inline dma_channel_config dma_channel_get_default_config(uint ch) { (void)ch; dma_channel_config c = {0}; return c; }
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) { (void)c; (void)size; }
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr) { (void)c; (void)incr; }
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr) { (void)c; (void)incr; }
+static inline void channel_config_set_dreq(dma_channel_config *c, uint dreq) { (void)c; (void)dreq; }
+static inline void dma_channel_configure(uint ch, const dma_channel_config *c, volatile void *write_addr,
+                                         const volatile void *read_addr, uint count, bool trigger) {
+    (void)ch; (void)c; (void)write_addr; (void)read_addr; (void)count; (void)trigger;
+}
+static inline void dma_channel_set_irq0_enabled(uint ch, bool enabled) { (void)ch; (void)enabled; }
+static inline void dma_channel_transfer_from_buffer_now(uint ch, const volatile void *read_addr, uint32_t count) {
+    (void)ch;
+    shim_dma_transfer((const uint32_t *)read_addr, count);
+}
+static inline bool dma_channel_get_irq0_status(uint ch) { (void)ch; return true; }
+static inline void dma_channel_acknowledge_irq0(uint ch) { (void)ch; }
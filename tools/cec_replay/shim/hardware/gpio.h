@@ -0,0 +1,8 @@
+#pragma once
+#include "../pico_shim.h"
+
+// tx_bench 用: 機能の切り替えは受け付けるだけ。バスは常に LOW (= directed の ACK あり) と読む
+#define GPIO_FUNC_SIO 5
+
+static inline void gpio_set_function(uint gpio, uint fn) { (void)gpio; (void)fn; }
+static inline bool gpio_get(uint gpio) { (void)gpio; return false; }
@@ -0,0 +1,16 @@
+#pragma once
+#include "../pico_shim.h"
+
+// ri_wave 用: 登録されたハンドラは転送完了の代わりに ri_wave.c から呼ぶ
+typedef void (*irq_handler_t)(void);
+
+#define DMA_IRQ_0 0
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+extern irq_handler_t shim_dma_irq;
+
+static inline void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order) {
+    (void)num; (void)order;
+    shim_dma_irq = handler;
+}
+static inline void irq_set_enabled(uint num, bool enabled) { (void)num; (void)enabled; }
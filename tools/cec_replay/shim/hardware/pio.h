@@ -0,0 +1,48 @@
+#pragma once
+#include "../pico_shim.h"
+
+// ri_wave / tx_bench 用: PIO は確保と設定を受け付けるだけ
+// (ri_wave は送出ワードを DMA の代替で、tx_bench は pio_sm_put_blocking で記録する)
+typedef struct {
+    volatile uint32_t txf[4];
+} pio_hw_t;
+typedef pio_hw_t *PIO;
+
+typedef struct {
+    const uint16_t *instructions;
+    uint8_t length;
+} pio_program_t;
+
+extern pio_hw_t shim_pio0;
+
+static inline bool pio_claim_free_sm_and_add_program_for_gpio_range(
+        const pio_program_t *program, PIO *pio, uint *sm, uint *offset,
+        uint gpio_base, uint gpio_count, bool set_gpio_base) {
+    (void)program; (void)gpio_base; (void)gpio_count; (void)set_gpio_base;
+    *pio = &shim_pio0;
+    *sm = 0;
+    *offset = 0;
+    return true;
+}
+static inline uint pio_get_dreq(PIO pio, uint sm, bool is_tx) { (void)pio; (void)sm; (void)is_tx; return 0; }
+static inline void pio_sm_set_clkdiv(PIO pio, uint sm, float div) { (void)pio; (void)sm; (void)div; }
+static inline bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm) { (void)pio; (void)sm; return true; }
+static inline uint8_t pio_sm_get_pc(PIO pio, uint sm) { (void)pio; (void)sm; return 0; }
+
+// tx_bench 用 (shim_pio_put は tx_bench.c)
+void shim_pio_put(uint32_t word);
+
+#define PIO_FUNCSEL_NUM(pio, gpio) 6
+
+static inline int pio_claim_unused_sm(PIO pio, bool required) { (void)pio; (void)required; return -1; }
+static inline uint pio_get_gpio_base(PIO pio) { (void)pio; return 0; }
+static inline uint pio_get_index(PIO pio) { (void)pio; return 0; }
+static inline uint pio_encode_jmp(uint addr) { return addr; }
+static inline void pio_sm_clear_fifos(PIO pio, uint sm) { (void)pio; (void)sm; }
+static inline void pio_sm_restart(PIO pio, uint sm) { (void)pio; (void)sm; }
+static inline void pio_sm_exec(PIO pio, uint sm, uint instr) { (void)pio; (void)sm; (void)instr; }
+static inline void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) { (void)pio; (void)sm; (void)enabled; }
+static inline void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+    (void)pio; (void)sm;
+    shim_pio_put(data);
+}
@@ -0,0 +1,73 @@
+#pragma once
+// ホスト用 Pico SDK 代替 (cec_replay 専用)
+// ファームウェアのソースが使う型・関数だけを用意する。
+// 時刻は仮想時刻 (キャプチャのタイムスタンプ)、GPIO は再生中のバス波形。
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+typedef unsigned int uint;
+
+// ---- platform ----
+#define __not_in_flash_func(name) name
+#define tight_loop_contents() ((void)0)
+static inline uint get_core_num(void) { return 0; }
+// 使うツールが定義する (ri_wave: メッセージを出して異常終了)
+void panic(const char *fmt, ...);
+
+// ---- time ----
+typedef uint64_t absolute_time_t;
+typedef int32_t  alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+
+extern uint64_t shim_now_us;
+
+static inline uint32_t time_us_32(void) { return (uint32_t)shim_now_us; }
+static inline uint64_t time_us_64(void) { return shim_now_us; }
+static inline absolute_time_t get_absolute_time(void) { return shim_now_us; }
+static inline bool is_nil_time(absolute_time_t t) { return t == 0; }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+static inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms) { return t + (uint64_t)ms * 1000u; }
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return shim_now_us + (uint64_t)ms * 1000u; }
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000u); }
+
+// 仮想時刻を進める (途中のアラームを発火し、バスの変化を ISR に届ける)
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t cb, void *user_data, bool fire_if_past);
+bool cancel_alarm(alarm_id_t id);
+
+// ---- sync ----
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void)status; }
+static inline void hw_set_bits(volatile uint32_t *addr, uint32_t mask) { *addr |= mask; }
+static inline void hw_clear_bits(volatile uint32_t *addr, uint32_t mask) { *addr &= ~mask; }
+
+// ---- gpio ----
+enum gpio_irq_level {
+    GPIO_IRQ_LEVEL_LOW  = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL  = 0x4u,
+    GPIO_IRQ_EDGE_RISE  = 0x8u,
+};
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback);
+
+typedef struct {
+    volatile uint32_t inte[6];
+    volatile uint32_t intf[6];
+    volatile uint32_t ints[6];
+} io_irq_ctrl_hw_t;
+
+typedef struct {
+    io_irq_ctrl_hw_t proc0_irq_ctrl;
+    io_irq_ctrl_hw_t proc1_irq_ctrl;
+} io_bank0_hw_t;
+
+extern io_bank0_hw_t shim_io_bank0;
+#define io_bank0_hw (&shim_io_bank0)
@@ -0,0 +1,12 @@
+#pragma once
+// ri_wave 用: pioasm が生成する ri_tx.pio.h の代替 (プログラム本体は不要)
+#include "hardware/pio.h"
+
+static const pio_program_t ri_tx_program    = { NULL, 4 };
+static const pio_program_t ri_tx_od_program = { NULL, 4 };
+
+static inline float ri_tx_clkdiv(void) { return 1.0f; }
+
+static inline void ri_tx_program_init(PIO pio, uint sm, uint offset, uint base, uint count, bool open_drive) {
+    (void)pio; (void)sm; (void)offset; (void)base; (void)count; (void)open_drive;
+}
@@ -0,0 +1,181 @@
+// CEC TX 送信準備のホスト計測
+// ファームウェアの src/cec/cec_tx.c と src/cec/cec_tx_cache.c をそのまま使い、次の 2 つを測る。
+//   start  : cec_tx_send_bytes() の呼び出し (送信キューがバスの空きを確認した直後) から
+//            Start ビットのワードを PIO に渡すまで。キャッシュ導入前と同じ区間
+//   prepare: cec_tx_cache_acquire() の一致 / 差分書き換え / 新規符号化 (送信キューへの投入時に行う)
+// PIO / GPIO は shim/ の代替。ACK 待ちとループバックは実行するが時間は進めない。
+//   build-replay/tx_bench [iterations]
+// 絶対値はホストの CPU のもの。実機 (RP2040 / RP2350) の値はデバッグコンソールの q で見る。
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "hardware/pio.h"
+#include "cec/cec_tx.h"
+#include "cec/cec_tx_cache.h"
+#include "cec/cec_od.h"
+#include "cec/cec_cal.h"
+#include "cec/cec_stats.h"
+#include "diag/stall.h"
+
+// ---- shim ----
+
+uint64_t shim_now_us;
+pio_hw_t shim_pio0;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// 送信中のフレーム (ループバックで RX が復号した結果として返す)
+static const uint8_t *g_frame;
+static size_t         g_frame_len;
+static uint64_t       g_start_ns;   // Start ビットを渡した時刻 (0 = まだ)
+
+void shim_pio_put(uint32_t word) {
+    if (!g_start_ns) {
+        g_start_ns = now_ns();
+    }
+    (void)word;
+}
+
+void panic(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+    exit(2);
+}
+
+void sleep_us(uint64_t us) { (void)us; }
+void sleep_ms(uint32_t ms) { (void)ms; }
+
+void cec_od_init(uint bus, uint gpio) { (void)bus; (void)gpio; }
+bool cec_od_read(uint bus) { (void)bus; return true; }
+
+void cec_rx_loopback_begin(uint bus) { (void)bus; }
+uint8_t cec_rx_loopback_end(uint bus, uint8_t *out, uint8_t max) {
+    (void)bus;
+    size_t n = g_frame_len < max ? g_frame_len : max;
+    memcpy(out, g_frame, n);
+    return (uint8_t)n;
+}
+
+uint32_t cec_cal_ack_sample_us(uint8_t follower) { (void)follower; return 1050; }
+
+void cec_stats_tx_attempt(void) {}
+void cec_stats_tx_retry(void) {}
+void cec_stats_tx_nack(bool header) { (void)header; }
+void cec_stats_tx_collision(void) {}
+void cec_stats_tx_bus_busy(void) {}
+
+void stall_enter(stall_site_t site) { (void)site; }
+void stall_leave(void) {}
+
+// ---- 計測 ----
+
+static volatile uint32_t g_sink;
+
+// 計測用フレーム: frames[n] を順に使う。想定した種別 (一致 / 差分 / 新規) にならなければ結果に印を付ける
+typedef struct {
+    const char *name;
+    size_t      len;
+    uint        count;
+    uint8_t     frames[CEC_TX_CACHE_SLOTS + 1][CEC_MAX_FRAME_BYTES];
+} bench_t;
+
+// 呼び出し → Start ビット (ワード列は用意済み)
+static double run_start(const bench_t *b, uint iters) {
+    cec_tx_cache_kind_t kind;
+    int slot = cec_tx_cache_acquire(b->frames[0], b->len, &kind);
+    const uint32_t *words = cec_tx_cache_words(slot);
+    g_frame = b->frames[0];
+    g_frame_len = b->len;
+
+    uint64_t sum = 0;
+    for (uint n = 0; n < iters; n++) {
+        g_start_ns = 0;
+        uint64_t t0 = now_ns();
+        cec_tx_send_bytes(CEC_BUS_MAIN, g_frame, g_frame_len, words);
+        sum += g_start_ns - t0;
+    }
+    cec_tx_cache_release(slot);
+    return (double)sum / iters;
+}
+
+// 送信キュー投入時の準備 (確保 + 解放)
+static double run_prepare(const bench_t *b, cec_tx_cache_kind_t expect, uint iters, bool *ok) {
+    cec_tx_cache_kind_t kind;
+    // 1 周目でキャッシュの状態を作る
+    for (uint i = 0; i < b->count; i++) {
+        cec_tx_cache_release(cec_tx_cache_acquire(b->frames[i], b->len, &kind));
+    }
+    *ok = true;
+    uint64_t t0 = now_ns();
+    for (uint n = 0; n < iters; n++) {
+        int slot = cec_tx_cache_acquire(b->frames[n % b->count], b->len, &kind);
+        g_sink = cec_tx_cache_words(slot)[0];
+        cec_tx_cache_release(slot);
+        *ok &= kind == expect;
+    }
+    return (double)(now_ns() - t0) / iters;
+}
+
+static void report(const bench_t *b, const char *kind, double ns, bool ok) {
+    printf("  %-22s %2u bytes  %-8s %7.1f ns%s\n", b->name, (unsigned)b->len, kind, ns,
+           ok ? "" : "  (kind mismatch)");
+}
+
+static void bench_start(const bench_t *b, uint iters) {
+    report(b, "start", run_start(b, iters), true);
+}
+
+static void bench_prepare(const bench_t *b, cec_tx_cache_kind_t expect, uint iters) {
+    static const char *const names[CEC_TX_CACHE_KIND_COUNT] = { "hit", "patched", "encoded" };
+    bool ok;
+    double ns = run_prepare(b, expect, iters, &ok);
+    report(b, names[expect], ns, ok);
+}
+
+int main(int argc, char **argv) {
+    uint iters = argc > 1 ? (uint)strtoul(argv[1], NULL, 0) : 1000000u;
+
+    cec_tx_init(CEC_BUS_MAIN, 0);
+
+    // Report Audio Status を TV へ (同じ値 = 一致)
+    static const bench_t hit3 = { "Report Audio Status", 3, 1, { { 0x50, 0x7A, 0x32 } } };
+    // 音量が変わるたびの Report Audio Status (状態バイトだけ違う = 差分書き換え)
+    static const bench_t patch3 = { "Report Audio Status", 3, 2, { { 0x50, 0x7A, 0x32 }, { 0x50, 0x7A, 0x33 } } };
+    // 長さが同じで 3 バイト以上違うフレームを CEC_TX_CACHE_SLOTS より多く回す (毎回新規符号化)
+    static bench_t miss3 = { "3-byte, 11 distinct", 3, CEC_TX_CACHE_SLOTS + 1, { { 0 } } };
+
+    // 最大長 (16 バイト) の Set OSD Name 相当
+    static const bench_t hit16 = { "16-byte frame", 16, 1, {
+        { 0x50, 0x47, 'O', 'N', 'K', 'Y', 'O', ' ', 'R', 'I', ' ', 'B', 'r', 'i', 'd', 'g' } } };
+    static const bench_t patch16 = { "16-byte frame", 16, 2, {
+        { 0x50, 0x47, 'O', 'N', 'K', 'Y', 'O', ' ', 'R', 'I', ' ', 'B', 'r', 'i', 'd', 'g' },
+        { 0x5F, 0x47, 'O', 'N', 'K', 'Y', 'O', ' ', 'R', 'I', ' ', 'B', 'r', 'i', 'd', 'x' } } };
+    static bench_t miss16 = { "16-byte, 11 distinct", 16, CEC_TX_CACHE_SLOTS + 1, { { 0 } } };
+    for (uint f = 0; f < miss16.count; f++) {
+        for (uint i = 0; i < CEC_MAX_FRAME_BYTES; i++) {
+            miss3.frames[f][i]  = (uint8_t)(f * 0x11u + i);
+            miss16.frames[f][i] = (uint8_t)(f * 0x11u + i);
+        }
+    }
+
+    printf("CEC TX call to start bit (host, %u iterations)\n", iters);
+    bench_start(&hit3, iters);
+    bench_start(&hit16, iters);
+
+    printf("CEC TX prepare at queue time (host, %u iterations)\n", iters);
+    bench_prepare(&hit3, CEC_TX_CACHE_HIT, iters);
+    bench_prepare(&patch3, CEC_TX_CACHE_PATCH, iters);
+    bench_prepare(&miss3, CEC_TX_CACHE_MISS, iters);
+    bench_prepare(&hit16, CEC_TX_CACHE_HIT, iters);
+    bench_prepare(&patch16, CEC_TX_CACHE_PATCH, iters);
+    bench_prepare(&miss16, CEC_TX_CACHE_MISS, iters);
+    return 0;
+}
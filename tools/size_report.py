@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+"""リンカマップ (GNU ld -Map) からモジュールごとの flash / RAM 使用量を集計する
+
+    size_report.py build/hdmi-cec-to-onkyo-ri-bridge.elf.map [-o report.txt]
+
+ファームウェアのソースはファイル単位 (src/cec/cec_rx など)、Pico SDK はライブラリ単位
+(sdk:pico_stdio_usb など)、ツールチェーンのライブラリはアーカイブ単位でまとめる。
+出力をビルド間で diff すれば、どのモジュールが増えたか分かる。
+"""
+import argparse
+import re
+import sys
+from collections import defaultdict
+
+# 出力セクション → (flash に載るか, RAM を占めるか)
+FLASH = {".boot2", ".text", ".rodata", ".ARM.extab", ".ARM.exidx", ".binary_info_header",
+         ".binary_info", ".flash_begin", ".flash_end", ".embedded_block", ".embedded_end_block"}
+FLASH_RAM = {".data", ".tdata", ".scratch_x", ".scratch_y"}    # flash からコピーされて RAM に常駐
+RAM = {".bss", ".tbss", ".uninitialized_data", ".ram_vector_table", ".heap",
+       ".stack_dummy", ".stack1_dummy"}
+
+SDK_DIRS = ("/src/rp2_common/", "/src/common/", "/src/rp2040/", "/src/rp2350/", "/src/host/")
+
+RE_OUT = re.compile(r"^(\.\S+)(\s+0x[0-9a-fA-F]+\s+0x[0-9a-fA-F]+.*)?$")
+RE_IN = re.compile(r"^ (\.\S+|COMMON|\*fill\*)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(.*))?)?$")
+RE_CONT = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+(.*))?$")
+
+
+def module_of(obj):
+    """オブジェクトファイルのパス → 集計キー"""
+    if not obj:
+        return "(linker)"
+    obj = obj.replace("\\", "/")
+    m = re.search(r"([^/]+\.a)\(", obj)
+    if m:
+        return m.group(1)                                  # libc / libgcc 等
+    if "/lib/tinyusb/" in obj:
+        return "sdk:tinyusb"
+    for d in SDK_DIRS:
+        i = obj.find(d)
+        if i >= 0:
+            return "sdk:" + obj[i + len(d):].split("/")[0]
+    m = re.search(r"\.dir/(?:.*/)?(src/.+?)\.(?:c|S|s|cpp)\.o(?:bj)?$", obj)
+    if m:
+        return m.group(1)                                  # ファームウェアのソース
+    return re.sub(r"\.(?:c|S|s|cpp)\.o(?:bj)?$", "", obj.rsplit("/", 1)[-1])
+
+
+def parse(path):
+    usage = defaultdict(lambda: [0, 0])                    # module -> [flash, ram]
+    out_sec = None
+    pending = None                                         # 次行に続く入力セクション名
+    in_map = False
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if not in_map:
+                in_map = line.startswith("Linker script and memory map")
+                continue
+            if not line.strip():
+                continue
+
+            m = RE_OUT.match(line)
+            if m and not line.startswith(" "):
+                out_sec = m.group(1)
+                pending = None
+                continue
+
+            size = obj = None
+            m = RE_IN.match(line)
+            if m:
+                if m.group(2) is None:
+                    pending = m.group(1)
+                    continue
+                size, obj = int(m.group(3), 16), m.group(4)
+                if m.group(1) == "*fill*":
+                    obj = "(fill)"
+            elif pending:
+                m = RE_CONT.match(line)
+                pending = None
+                if not m:
+                    continue
+                size, obj = int(m.group(2), 16), m.group(3)
+            else:
+                continue
+
+            if not size or out_sec is None:
+                continue
+            key = obj if obj == "(fill)" else module_of(obj)
+            if out_sec in FLASH:
+                usage[key][0] += size
+            elif out_sec in FLASH_RAM:
+                usage[key][0] += size
+                usage[key][1] += size
+            elif out_sec in RAM:
+                usage[key][1] += size
+    return usage
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    ap.add_argument("map")
+    ap.add_argument("-o", "--output", help="write report to file (default: stdout)")
+    args = ap.parse_args()
+
+    usage = parse(args.map)
+    if not usage:
+        sys.exit(f"size_report: no memory map found in {args.map}")
+
+    rows = sorted(usage.items(), key=lambda kv: (-kv[1][0], -kv[1][1], kv[0]))
+    width = max(len(k) for k in usage) + 2
+    total_flash = sum(v[0] for v in usage.values())
+    total_ram = sum(v[1] for v in usage.values())
+    fw_flash = sum(v[0] for k, v in usage.items() if k.startswith("src/"))
+    fw_ram = sum(v[1] for k, v in usage.items() if k.startswith("src/"))
+
+    lines = [f"{'module':<{width}}{'flash':>9}{'ram':>9}"]
+    for k, (fl, ram) in rows:
+        lines.append(f"{k:<{width}}{fl:>9}{ram:>9}")
+    lines.append(f"{'firmware (src/)':<{width}}{fw_flash:>9}{fw_ram:>9}")
+    lines.append(f"{'total':<{width}}{total_flash:>9}{total_ram:>9}")
+    text = "\n".join(lines) + "\n"
+
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+        print(f"size_report: flash {total_flash} B (firmware {fw_flash} B), "
+              f"ram {total_ram} B (firmware {fw_ram} B) -> {args.output}")
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()